@@ -0,0 +1,76 @@
+#include "AllocationCounter.hpp"
+
+#ifdef COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+// Per thread, so that the pool's workers and background jobs don't show up
+// in the figures of the thread that reads them.
+static thread_local size_t allocations = 0;
+
+static void *countedAllocate(size_t size) {
+  ++allocations;
+  if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+static void *countedAllocate(size_t size, std::align_val_t alignment) {
+  ++allocations;
+  const size_t align = static_cast<size_t>(alignment);
+  // aligned_alloc wants a size that is a multiple of the alignment.
+  size = ((size == 0 ? 1 : size) + align - 1) / align * align;
+#ifdef _WIN32
+  void *pointer = _aligned_malloc(size, align);
+#else
+  void *pointer = std::aligned_alloc(align, size);
+#endif
+  if (pointer) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+static void alignedFree(void *pointer) {
+#ifdef _WIN32
+  _aligned_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+void *operator new(size_t size) { return countedAllocate(size); }
+void *operator new[](size_t size) { return countedAllocate(size); }
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { std::free(pointer); }
+
+void *operator new(size_t size, std::align_val_t alignment) {
+  return countedAllocate(size, alignment);
+}
+void *operator new[](size_t size, std::align_val_t alignment) {
+  return countedAllocate(size, alignment);
+}
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  alignedFree(pointer);
+}
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+  alignedFree(pointer);
+}
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+  alignedFree(pointer);
+}
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept {
+  alignedFree(pointer);
+}
+
+size_t AllocationCounter::count() { return allocations; }
+
+#else
+
+size_t AllocationCounter::count() { return 0; }
+
+#endif
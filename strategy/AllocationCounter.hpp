@@ -0,0 +1,19 @@
+#ifndef _ALLOCATION_COUNTER_HPP_
+#define _ALLOCATION_COUNTER_HPP_
+
+#include <cstddef>
+
+// Heap allocation counting is compiled in for debug builds, or on demand with
+// -DCOUNT_ALLOCATIONS. Otherwise the global operator new is left untouched and
+// count() always returns zero.
+#if defined(_DEBUG) && !defined(COUNT_ALLOCATIONS)
+#define COUNT_ALLOCATIONS
+#endif
+
+class AllocationCounter {
+public:
+  // Allocations made so far by the calling thread.
+  static size_t count();
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "BulletSimulator.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	constexpr double NEVER = std::numeric_limits<double>::infinity();
+	constexpr int NO_UNIT = -1;
+}
+
+BulletSimulator::BulletSimulator(Properties const& properties, Level const& level, int horizon)
+	: m_line_of_fire(level)
+	, m_ticks_per_second(properties.ticksPerSecond)
+	, m_horizon(horizon)
+{
+}
+
+void BulletSimulator::prepare(Game const& game)
+{
+	auto const count = game.bullets.size();
+	m_x.resize(count);
+	m_y.resize(count);
+	m_vx.resize(count);
+	m_vy.resize(count);
+	m_half.resize(count);
+	m_damage.resize(count);
+	m_owner.resize(count);
+	m_wall_time.resize(count);
+	m_first_stop.resize(count);
+	m_second_stop.resize(count);
+	m_units.resize(game.units.size());
+	for (size_t i = 0; i < game.units.size(); ++i)
+		m_units[i] = &game.units[i];
+	m_timelines.assign(game.units.size() * m_horizon, 0);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto const& bullet = game.bullets[i];
+		m_x[i] = bullet.position.x;
+		m_y[i] = bullet.position.y;
+		m_vx[i] = bullet.velocity.x / m_ticks_per_second;
+		m_vy[i] = bullet.velocity.y / m_ticks_per_second;
+		m_half[i] = bullet.size / 2.0;
+		m_damage[i] = bullet.damage;
+		m_owner[i] = bullet.unitId;
+
+		Vec2Double const end(m_x[i] + m_vx[i] * m_horizon, m_y[i] + m_vy[i] * m_horizon);
+		auto const wall = m_line_of_fire.wall_hit(bullet.position, end, bullet.size);
+		m_wall_time[i] = wall > 1.0 ? NEVER : wall * m_horizon;
+
+		Stop first = { NO_UNIT, NEVER };
+		Stop second = { NO_UNIT, NEVER };
+		for (size_t j = 0; j < game.units.size(); ++j)
+		{
+			auto const& unit = game.units[j];
+			if (unit.id == bullet.unitId)
+				continue;
+			auto const hit = LineOfFire::unit_hit(bullet.position, end, bullet.size, unit);
+			if (hit > 1.0)
+				continue;
+			Stop const stop = { static_cast<int>(j), hit * m_horizon };
+			if (stop.time < first.time)
+			{
+				second = first;
+				first = stop;
+			}
+			else if (stop.time < second.time)
+				second = stop;
+		}
+		m_first_stop[i] = first;
+		m_second_stop[i] = second;
+
+		if (first.unit != NO_UNIT && first.time < m_wall_time[i])
+			m_timelines[first.unit * m_horizon + std::min(static_cast<int>(first.time), m_horizon - 1)] += bullet.damage;
+	}
+}
+
+// Each bullet is checked only over the ticks in which its path crosses the
+// box around the whole trajectory, and then swept tick by tick against the
+// unit's box in the unit's frame of reference.
+int BulletSimulator::damage_along(size_t index, Vec2Double const* trajectory, int ticks, int * timeline) const
+{
+	ticks = std::min(ticks, m_horizon);
+	if (ticks <= 0)
+		return 0;
+	auto const& unit = *m_units[index];
+
+	auto min_x = unit.position.x;
+	auto max_x = unit.position.x;
+	auto min_y = unit.position.y;
+	auto max_y = unit.position.y;
+	for (auto k = 0; k < ticks; ++k)
+	{
+		min_x = std::min(min_x, trajectory[k].x);
+		max_x = std::max(max_x, trajectory[k].x);
+		min_y = std::min(min_y, trajectory[k].y);
+		max_y = std::max(max_y, trajectory[k].y);
+	}
+	// The box the unit sweeps over the whole trajectory.
+	Vec2Double const swept_position((min_x + max_x) / 2.0, min_y);
+	Vec2Double const swept_size(max_x - min_x + unit.size.x, max_y - min_y + unit.size.y);
+
+	auto total = 0;
+	for (size_t i = 0; i < m_x.size(); ++i)
+	{
+		if (m_owner[i] == unit.id)
+			continue;
+		auto end = std::min(m_wall_time[i], static_cast<double>(ticks));
+		auto const& stop = m_first_stop[i].unit == static_cast<int>(index) ? m_second_stop[i] : m_first_stop[i];
+		end = std::min(end, stop.time);
+		if (end <= 0.0)
+			continue;
+
+		auto const size = m_half[i] * 2.0;
+		Vec2Double const origin(m_x[i], m_y[i]);
+		Vec2Double const path_end(m_x[i] + m_vx[i] * end, m_y[i] + m_vy[i] * end);
+		auto const reach = LineOfFire::box_hit(origin, path_end, size, swept_position, swept_size);
+		if (reach > 1.0)
+			continue;
+
+		for (auto k = static_cast<int>(reach * end); k < end; ++k)
+		{
+			auto const& from = k == 0 ? unit.position : trajectory[k - 1];
+			auto const& to = trajectory[k];
+			auto const bx = m_x[i] + m_vx[i] * k;
+			auto const by = m_y[i] + m_vy[i] * k;
+			Vec2Double const relative_from(bx - from.x, by - from.y);
+			Vec2Double const relative_to(bx + m_vx[i] - to.x, by + m_vy[i] - to.y);
+			auto const hit = LineOfFire::box_hit(relative_from, relative_to, size, Vec2Double(0.0, 0.0), unit.size);
+			if (hit <= 1.0 && k + hit < end)
+			{
+				total += m_damage[i];
+				if (timeline != nullptr)
+					timeline[k] += m_damage[i];
+				break;
+			}
+		}
+	}
+	return total;
+}
@@ -0,0 +1,65 @@
+#ifndef _BULLET_SIMULATOR_HPP_
+#define _BULLET_SIMULATOR_HPP_
+
+#include "LineOfFire.hpp"
+#include "model/Game.hpp"
+
+#include <vector>
+
+// Flight of the bullets in a game over the next `horizon` ticks. Bullets fly
+// straight at constant speed until they hit a wall or a unit; times are in
+// ticks from now.
+class BulletSimulator final
+{
+public:
+	BulletSimulator(Properties const& properties, Level const& level, int horizon);
+
+	// Traces every bullet in flight against the walls and the units, which are
+	// taken to keep still. Called once per game tick.
+	void prepare(Game const& game);
+
+	int horizon() const { return m_horizon; }
+	size_t bullet_count() const { return m_x.size(); }
+
+	// Damage game.units[index] takes in each of the next ticks if it keeps
+	// still.
+	int const* timeline(size_t index) const { return m_timelines.data() + index * m_horizon; }
+
+	// Damage game.units[index] takes following a candidate trajectory: its
+	// positions at the end of each of the next `ticks` ticks. The other units
+	// keep still and stop the bullets that reach them first. The damage per
+	// tick is added to `timeline` when it isn't null.
+	int damage_along(size_t index, Vec2Double const* trajectory, int ticks, int * timeline = nullptr) const;
+
+private:
+	// A unit in the path of a bullet, and the time the bullet reaches it.
+	struct Stop
+	{
+		int unit;
+		double time;
+	};
+
+	LineOfFire m_line_of_fire;
+	double m_ticks_per_second;
+	int m_horizon;
+
+	// Bullets as parallel arrays: start, velocity per tick, half size,
+	// damage, owner and the time the flight ends at a wall.
+	std::vector<double> m_x;
+	std::vector<double> m_y;
+	std::vector<double> m_vx;
+	std::vector<double> m_vy;
+	std::vector<double> m_half;
+	std::vector<int> m_damage;
+	std::vector<int> m_owner;
+	std::vector<double> m_wall_time;
+	// The second unit in the path takes over when the first one is the unit
+	// following a candidate trajectory.
+	std::vector<Stop> m_first_stop;
+	std::vector<Stop> m_second_stop;
+
+	std::vector<Unit const*> m_units;
+	std::vector<int> m_timelines;
+};
+
+#endif
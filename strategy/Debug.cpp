@@ -1,11 +1,88 @@
 #include "Debug.hpp"
 #include "model/PlayerMessageGame.hpp"
 
-Debug::Debug(const std::shared_ptr<OutputStream> &outputStream)
-    : outputStream(outputStream) {}
+#ifdef _DEBUG
+
+Debug::Debug(const std::shared_ptr<OutputStream> &outputStream,
+             size_t commandBudget, size_t byteBudget, DropPolicy dropPolicy)
+    : outputStream(outputStream), commandBudget(commandBudget),
+      byteBudget(byteBudget), dropPolicy(dropPolicy), firstCommand(0),
+      droppedCommands(0) {
+  queue.bytes.reserve(byteBudget);
+  commandOffsets.reserve(commandBudget);
+}
+
+size_t Debug::queuedCommands() const {
+  return commandOffsets.size() - firstCommand;
+}
+
+size_t Debug::queuedBytes() const {
+  if (firstCommand == commandOffsets.size()) {
+    return 0;
+  }
+  return queue.bytes.size() - commandOffsets[firstCommand];
+}
 
 void Debug::draw(const CustomData &customData) {
-  outputStream->write(PlayerMessageGame::CustomDataMessage::TAG);
-  customData.writeTo(*outputStream);
-  outputStream->flush();
-}
\ No newline at end of file
+  size_t begin = queue.bytes.size();
+  queue.write(PlayerMessageGame::CustomDataMessage::TAG);
+  customData.writeTo(queue);
+  size_t size = queue.bytes.size() - begin;
+  if (dropPolicy == DROP_NEWEST && (queuedCommands() >= commandBudget ||
+                                    queuedBytes() + size > byteBudget)) {
+    queue.bytes.resize(begin);
+    droppedCommands++;
+    return;
+  }
+  commandOffsets.push_back(begin);
+  while (queuedCommands() > commandBudget || queuedBytes() > byteBudget) {
+    firstCommand++;
+    droppedCommands++;
+  }
+  if (firstCommand > 0) {
+    compact();
+  }
+}
+
+// Moves the commands still queued to the front, so dropping the oldest ones
+// keeps the queue within the bytes reserved for it.
+void Debug::compact() {
+  size_t begin = firstCommand < commandOffsets.size()
+                     ? commandOffsets[firstCommand]
+                     : queue.bytes.size();
+  queue.bytes.erase(queue.bytes.begin(), queue.bytes.begin() + begin);
+  commandOffsets.erase(commandOffsets.begin(),
+                       commandOffsets.begin() + firstCommand);
+  for (size_t &offset : commandOffsets) {
+    offset -= begin;
+  }
+  firstCommand = 0;
+}
+
+void Debug::flush() {
+  if (droppedCommands > 0) {
+    size_t begin = queue.bytes.size();
+    queue.write(PlayerMessageGame::CustomDataMessage::TAG);
+    CustomData::Log("Debug: dropped " + std::to_string(droppedCommands) +
+                    " commands")
+        .writeTo(queue);
+    commandOffsets.push_back(begin);
+  }
+  if (firstCommand < commandOffsets.size()) {
+    size_t begin = commandOffsets[firstCommand];
+    outputStream->writeBytes(queue.bytes.data() + begin,
+                             queue.bytes.size() - begin);
+  }
+  queue.bytes.clear();
+  commandOffsets.clear();
+  firstCommand = 0;
+  droppedCommands = 0;
+}
+
+#else
+
+Debug::Debug(const std::shared_ptr<OutputStream> &outputStream, size_t, size_t,
+             DropPolicy)
+    : outputStream(outputStream) {}
+
+#endif
@@ -4,14 +4,50 @@
 #include "Stream.hpp"
 #include "model/CustomData.hpp"
 #include <memory>
+#include <vector>
 
+// Debug commands are queued during a tick and written to the output stream
+// in one piece by flush(), right before the action message. In release
+// builds draw() and flush() are empty.
 class Debug {
 public:
-  Debug(const std::shared_ptr<OutputStream> &outputStream);
+  enum DropPolicy { DROP_NEWEST, DROP_OLDEST };
+
+  Debug(const std::shared_ptr<OutputStream> &outputStream,
+        size_t commandBudget = 256, size_t byteBudget = 6 * 1024,
+        DropPolicy dropPolicy = DROP_NEWEST);
+#ifdef _DEBUG
   void draw(const CustomData &customData);
+  void flush();
+#else
+  void draw(const CustomData &) {}
+  void flush() {}
+#endif
 
 private:
   std::shared_ptr<OutputStream> outputStream;
+#ifdef _DEBUG
+  class QueueStream : public OutputStream {
+  public:
+    std::vector<char> bytes;
+    void writeBytes(const char *buffer, size_t byteCount) {
+      bytes.insert(bytes.end(), buffer, buffer + byteCount);
+    }
+    void flush() {}
+  };
+
+  size_t queuedCommands() const;
+  size_t queuedBytes() const;
+  void compact();
+
+  size_t commandBudget;
+  size_t byteBudget;
+  DropPolicy dropPolicy;
+  QueueStream queue;
+  std::vector<size_t> commandOffsets;
+  size_t firstCommand;
+  size_t droppedCommands;
+#endif
 };
 
-#endif
\ No newline at end of file
+#endif
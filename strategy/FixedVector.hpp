@@ -0,0 +1,71 @@
+#ifndef _FIXED_VECTOR_HPP_
+#define _FIXED_VECTOR_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+// A vector with its capacity inline: it never allocates, and copies only
+// the elements in use. Holds only as much of std::vector's interface as the
+// simulation uses.
+template <typename T, size_t N>
+class FixedVector final
+{
+public:
+	FixedVector()
+		: m_size(0)
+	{
+	}
+
+	FixedVector(FixedVector const& other)
+		: m_size(other.m_size)
+	{
+		std::copy(other.begin(), other.end(), m_items);
+	}
+
+	FixedVector & operator=(FixedVector const& other)
+	{
+		m_size = other.m_size;
+		std::copy(other.begin(), other.end(), m_items);
+		return *this;
+	}
+
+	static constexpr size_t capacity() { return N; }
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	bool full() const { return m_size == N; }
+
+	T * begin() { return m_items; }
+	T * end() { return m_items + m_size; }
+	T const* begin() const { return m_items; }
+	T const* end() const { return m_items + m_size; }
+
+	T & operator[](size_t index) { return m_items[index]; }
+	T const& operator[](size_t index) const { return m_items[index]; }
+
+	void clear() { m_size = 0; }
+
+	void push_back(T const& item)
+	{
+		if (m_size == N)
+			throw std::length_error("FixedVector is full");
+		m_items[m_size++] = item;
+	}
+
+	T * erase(T * first, T * last)
+	{
+		auto const tail = end();
+		auto target = first;
+		for (auto source = last; source != tail; ++source, ++target)
+			*target = std::move(*source);
+		m_size = target - m_items;
+		return first;
+	}
+
+private:
+	size_t m_size;
+	T m_items[N];
+};
+
+#endif
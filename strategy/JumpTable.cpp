@@ -0,0 +1,85 @@
+#include "JumpTable.hpp"
+#include "Simulator.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	constexpr double EPS = 1e-9;
+}
+
+JumpTable::JumpTable(Game const& game)
+	: m_height(game.level.height)
+	, m_arcs(game.level.width * game.level.height * INPUT_COUNT, Arc { 0, 0, false })
+{
+	auto const& level = game.level;
+	auto const& properties = game.properties;
+	if (game.units.empty())
+		throw std::runtime_error("No unit to build the jump table for");
+	if (level.width > UINT8_MAX || level.height > UINT8_MAX)
+		throw std::runtime_error("Level too large for the jump table");
+
+	// The unit jumps alone: no other units, bullets or mines.
+	auto world = game;
+	world.units.assign(1, game.units.front());
+	world.bullets.clear();
+	world.mines.clear();
+	auto & unit = world.units.front();
+	auto const prototype = unit;
+	JumpState const ground_jump(true, properties.unitJumpSpeed, properties.unitJumpTime, true);
+	Simulator const simulator(properties, level);
+	auto const rows = static_cast<int>(std::ceil(prototype.size.y));
+
+	for (auto x = 0; x < level.width; ++x)
+	{
+		for (auto y = 1; y + rows <= level.height; ++y)
+		{
+			auto free = true;
+			for (auto row = y; row < y + rows; ++row)
+				free = free && !level.isSolid(x, row);
+			if (!free || !(level.isStandable(x, y - 1) || level.isLadder(x, y)))
+				continue;
+
+			for (auto input = 0; input < INPUT_COUNT; ++input)
+			{
+				unit = prototype;
+				unit.position = Vec2Double(x + 0.5, y);
+				unit.jumpState = ground_jump;
+				unit.onGround = true;
+				UnitAction action;
+				action.velocity = (input - UP) * properties.unitMaxHorizontalSpeed;
+				action.jump = true;
+				action.jumpDown = false;
+				action.aim = Vec2Double(0.0, 0.0);
+				action.shoot = false;
+				action.reload = false;
+				action.swapWeapon = false;
+				action.plantMine = false;
+
+				auto & arc = m_arcs[(x * m_height + y) * INPUT_COUNT + input];
+				arc.first = static_cast<uint32_t>(m_cells.size());
+				// Jump is held for as long as the jump lasts: until it runs
+				// out or hits a ceiling, or the unit is back on the ground.
+				for (auto tick = 1; tick <= MAX_TICKS; ++tick)
+				{
+					simulator.tick(world, &action);
+					action.jump = action.jump && unit.jumpState.canJump && !unit.onGround;
+					m_cells.push_back(cell_of(unit.position));
+					arc.ticks = static_cast<uint8_t>(tick);
+					if (!action.jump && (unit.onGround || unit.onLadder))
+					{
+						arc.lands = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+	m_cells.shrink_to_fit();
+}
+
+int JumpTable::floor_cell(double coordinate)
+{
+	return static_cast<int>(std::floor(coordinate + EPS));
+}
@@ -0,0 +1,76 @@
+#ifndef _JUMP_TABLE_HPP_
+#define _JUMP_TABLE_HPP_
+
+#include "model/Game.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Jump arcs from every cell a unit can stand in, simulated once per level:
+// the cells the unit passes through tick by tick while it jumps as high as
+// it can with one horizontal input held, and where it lands. Planners
+// expand movement edges from the table instead of simulating them.
+class JumpTable final
+{
+public:
+	enum Input
+	{
+		LEFT,
+		UP,
+		RIGHT,
+		INPUT_COUNT
+	};
+
+	// Arcs that haven't landed by then are cut off.
+	static constexpr int MAX_TICKS = 120;
+
+	struct Cell
+	{
+		uint8_t x;
+		uint8_t y;
+	};
+
+	struct Arc
+	{
+		// Index of the cell after the first tick in the cell pool.
+		uint32_t first;
+		uint8_t ticks;
+		bool lands;
+	};
+
+	// Simulates the arcs of a unit like game.units.front().
+	explicit JumpTable(Game const& game);
+
+	// The cell a coordinate falls in. A unit resting on a row can stop a
+	// rounding error short of it; the Simulator counts such positions in the
+	// row, and so do the table and the graph built on it.
+	static int floor_cell(double coordinate);
+	static Cell cell_of(Vec2Double const& position)
+	{
+		return { static_cast<uint8_t>(floor_cell(position.x)), static_cast<uint8_t>(floor_cell(position.y)) };
+	}
+
+	// A unit centered in the column stands with its feet on the bottom of
+	// the cell: on a wall, platform or ladder top, or holding a ladder.
+	bool is_standing(int x, int y) const { return m_arcs[(x * m_height + y) * INPUT_COUNT].ticks != 0; }
+
+	// The arc jumping from standing cell (x, y), or nullptr when the unit
+	// can't stand there.
+	Arc const* arc(int x, int y, Input input) const
+	{
+		auto const& arc = m_arcs[(x * m_height + y) * INPUT_COUNT + input];
+		return arc.ticks != 0 ? &arc : nullptr;
+	}
+
+	// The cell of the unit's feet at the end of each tick of the arc; the
+	// last one is where it lands.
+	Cell const* cells(Arc const& arc) const { return m_cells.data() + arc.first; }
+	Cell landing(Arc const& arc) const { return cells(arc)[arc.ticks - 1]; }
+
+private:
+	int m_height;
+	std::vector<Arc> m_arcs;
+	std::vector<Cell> m_cells;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "LineOfFire.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// Keeps a bullet that exactly touches a tile or a box from counting as
+	// overlapping it.
+	constexpr double EPS = 1e-9;
+}
+
+LineOfFire::LineOfFire(Level const& level)
+	: m_level(&level)
+{
+}
+
+// A square smaller than a tile can only touch a tile with one of its
+// corners inside it, so following the four corners finds the first wall.
+double LineOfFire::wall_hit(Vec2Double const& from, Vec2Double const& to, double bullet_size) const
+{
+	auto const half = std::max(0.0, bullet_size / 2.0 - EPS);
+	auto const dx = to.x - from.x;
+	auto const dy = to.y - from.y;
+	auto hit = MISS;
+	for (auto const sx : { -half, half })
+		for (auto const sy : { -half, half })
+			hit = std::min(hit, corner_hit(from.x + sx, from.y + sy, dx, dy));
+	return hit;
+}
+
+double LineOfFire::corner_hit(double x0, double y0, double dx, double dy) const
+{
+	auto const infinity = std::numeric_limits<double>::infinity();
+	auto x = static_cast<int>(std::floor(x0));
+	auto y = static_cast<int>(std::floor(y0));
+	auto const step_x = dx > 0.0 ? 1 : -1;
+	auto const step_y = dy > 0.0 ? 1 : -1;
+	auto const delta_x = dx != 0.0 ? std::abs(1.0 / dx) : infinity;
+	auto const delta_y = dy != 0.0 ? std::abs(1.0 / dy) : infinity;
+	auto next_x = dx > 0.0 ? (x + 1 - x0) / dx : dx < 0.0 ? (x - x0) / dx : infinity;
+	auto next_y = dy > 0.0 ? (y + 1 - y0) / dy : dy < 0.0 ? (y - y0) / dy : infinity;
+	auto t = 0.0;
+	while (t <= 1.0)
+	{
+		if (!m_level->isInside(x, y) || m_level->isSolid(x, y))
+			return t;
+		if (next_x < next_y)
+		{
+			t = next_x;
+			next_x += delta_x;
+			x += step_x;
+		}
+		else
+		{
+			t = next_y;
+			next_y += delta_y;
+			y += step_y;
+		}
+	}
+	return MISS;
+}
+
+double LineOfFire::box_hit(Vec2Double const& from, Vec2Double const& to, double bullet_size, Vec2Double const& position, Vec2Double const& size)
+{
+	auto const half = bullet_size / 2.0 - EPS;
+	auto enter = 0.0;
+	auto exit = 1.0;
+	const auto slab = [&] (double origin, double delta, double low, double high) {
+		if (delta == 0.0)
+			return low < origin && origin < high;
+		auto low_t = (low - origin) / delta;
+		auto high_t = (high - origin) / delta;
+		if (low_t > high_t)
+			std::swap(low_t, high_t);
+		enter = std::max(enter, low_t);
+		exit = std::min(exit, high_t);
+		return enter < exit;
+	};
+	auto const half_width = size.x / 2.0 + half;
+	if (!slab(from.x, to.x - from.x, position.x - half_width, position.x + half_width))
+		return MISS;
+	if (!slab(from.y, to.y - from.y, position.y - half, position.y + size.y + half))
+		return MISS;
+	return enter;
+}
@@ -0,0 +1,40 @@
+#ifndef _LINE_OF_FIRE_HPP_
+#define _LINE_OF_FIRE_HPP_
+
+#include "model/Level.hpp"
+#include "model/Unit.hpp"
+#include "model/Vec2Double.hpp"
+
+// Where a square bullet flying from `from` to `to` first touches a wall or a
+// unit, as the fraction t of the way along the segment; MISS (above 1) when
+// it gets through. Bullets are assumed smaller than a tile.
+class LineOfFire final
+{
+public:
+	static constexpr double MISS = 2.0;
+
+	explicit LineOfFire(Level const& level);
+
+	// Traces the corners of the bullet through the tile grid with
+	// Amanatides-Woo traversal: the cost is the number of cells crossed.
+	double wall_hit(Vec2Double const& from, Vec2Double const& to, double bullet_size) const;
+	bool is_clear(Vec2Double const& from, Vec2Double const& to, double bullet_size) const
+	{
+		return wall_hit(from, to, bullet_size) > 1.0;
+	}
+
+	// Exact segment test against a box grown by half the bullet; boxes are
+	// placed by the middle of their bottom edge, as units and mines are.
+	static double box_hit(Vec2Double const& from, Vec2Double const& to, double bullet_size, Vec2Double const& position, Vec2Double const& size);
+	static double unit_hit(Vec2Double const& from, Vec2Double const& to, double bullet_size, Unit const& unit)
+	{
+		return box_hit(from, to, bullet_size, unit.position, unit.size);
+	}
+
+private:
+	double corner_hit(double x0, double y0, double dx, double dy) const;
+
+	Level const* m_level;
+};
+
+#endif
@@ -1,9 +1,12 @@
 #include "MyStrategy.hpp"
+#include "LineOfFire.hpp"
 
 #include <optional>
 #include <map>
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
+#include <string>
 
 #ifdef _DEBUG
 	#define DEBUG_DRAW(something) debug.draw(something)
@@ -29,10 +32,64 @@ public:
 	}
 };
 
+MyStrategy::MyStrategy(ThreadPool & pool, double planBudgetMs)
+	: m_plan_budget(static_cast<std::chrono::microseconds::rep>(planBudgetMs * 1000.0))
+	, m_pool(&pool)
+{
+}
+
 UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & debug)
 {
-	static decltype(unit.id) first_unit = unit.id;
+	if (m_planned_tick != game.currentTick)
+		planTeam(game, unit.playerId, debug);
+	for (auto const& planned : m_planned)
+		if (planned.first == unit.id)
+			return planned.second;
+	throw std::runtime_error("No plan for unit " + std::to_string(unit.id));
+}
+
+void MyStrategy::planTeam(Game const& game, int playerId, Debug & debug)
+{
+	auto const deadline = TeamPlanner::Clock::now() + m_plan_budget;
+	if (!m_context)
+	{
+		m_world = World::of(game);
+		m_navigation = Navigation::build(game, *m_pool);
+		m_context = std::make_unique<TickContext>(*m_world, *m_navigation);
+		m_planner = std::make_unique<TeamPlanner>(*m_world, *m_context, *m_pool);
+	}
+	m_context->reset(game, playerId);
+
+	// Each unit picks what it would do on its own, then the movement is
+	// planned for the team.
+	m_members.clear();
+	for (size_t i = 0; i < game.units.size(); ++i)
+	{
+		auto const& unit = game.units[i];
+		if (unit.playerId != playerId)
+			continue;
+		Vec2Double target;
+		auto const action = heuristicAction(unit, game, debug, target);
+		m_members.push_back({ i, action, target });
+	}
+	m_planner->plan(game, m_members, deadline);
+	DEBUG_DRAW(CustomData::Log("Plans scored: " + std::to_string(m_planner->rollouts())));
+
+	m_planned.clear();
+	for (auto const& member : m_members)
+		m_planned.emplace_back(game.units[member.index].id, member.action);
+	m_planned_tick = game.currentTick;
 
+	for (auto const& u : game.units)
+	{
+		if (u.playerId == playerId)
+			continue;
+		m_prev_pos[u.id] = { u.position.x, u.position.y + game.properties.unitSize.y / 2.0 };
+	}
+}
+
+UnitAction MyStrategy::heuristicAction(Unit const& unit, Game const& game, Debug & debug, Vec2Double & target)
+{
 	const auto distance = [&] (double x, double y) {
 		return std::abs(unit.position.x - x) + std::abs(unit.position.y - y);
 	};
@@ -69,41 +126,29 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 		return full_cross(u_x_left, u_x_right, u_y_top, u_y_bottom, x_left, x_right, y_top, y_bottom);
 	};
 
+	auto & context = *m_context;
+
 	const auto nearest_enemy = [&] () {
-		auto min_distance = std::numeric_limits<double>::max();
 		std::optional<std::pair<std::pair<double, double>, decltype(unit.id)>> result;
-		for (auto const& u : game.units)
-		{
-			if (u.playerId == unit.playerId)
-				continue;
-			auto const d = distance(u.position.x, u.position.y + game.properties.unitSize.y / 2.0);
-			if (d < min_distance)
-			{
-				min_distance = d;
-				result = { { u.position.x, u.position.y + game.properties.unitSize.y / 2.0 }, u.id };
-			}
-		}
+		auto const u = context.nearest_enemy(unit);
+		if (u != nullptr)
+			result = { { u->position.x, u->position.y + game.properties.unitSize.y / 2.0 }, u->id };
 		return result;
 	};
 
+	const auto get_unit = [&] (decltype(unit.id) id) -> Unit const&
+	{
+		for (auto const& u : game.units)
+			if (u.id == id)
+				return u;
+		return unit;
+	};
+
 	const auto nearest_hp = [&] () {
-		auto min_distance = std::numeric_limits<double>::max();
 		std::optional<std::pair<double, double>> result;
-		auto const e = nearest_enemy();
-		for (auto const& l : game.lootBoxes)
-		{
-			auto const hp = std::dynamic_pointer_cast<const Item::HealthPack>(l.item);
-			if (hp == nullptr)
-				continue;
-			auto d = distance(l.position.x, l.position.y);
-			if (e.has_value() && std::abs(e.value().first.first - l.position.x) + std::abs(e.value().first.second - l.position.y) < d)
-				d += 100.0;
-			if (d < min_distance)
-			{
-				min_distance = d;
-				result = { l.position.x, l.position.y };
-			}
-		}
+		auto const l = context.nearest_health_pack(unit);
+		if (l != nullptr)
+			result = { l->position.x, l->position.y };
 		return result;
 	};
 
@@ -111,34 +156,26 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 
 	const auto nearest_weapon = [&] () {
 		std::optional<std::pair<double, double>> result;
-		if (unit.weapon != nullptr && unit.weapon->typ == best_weapon)
+		if (unit.weapon.has_value() && unit.weapon->typ == best_weapon)
 			return result;
-		auto min_distance = std::numeric_limits<double>::max();
-		for (auto const& l : game.lootBoxes)
+		auto min_time = std::numeric_limits<double>::infinity();
+		for (auto type = 0; type < WEAPON_TYPE_COUNT; ++type)
 		{
-			auto const w = std::dynamic_pointer_cast<const Item::Weapon>(l.item);
-			if (w == nullptr)
+			if (unit.weapon.has_value() && type != best_weapon)
 				continue;
-			if (unit.weapon != nullptr && w->weaponType != best_weapon)
+			auto const l = context.nearest_weapon(unit, static_cast<WeaponType>(type));
+			if (l == nullptr)
 				continue;
-			auto const d = distance(l.position.x, l.position.y);
-			if (d < min_distance)
+			auto const t = context.travel_time(unit.position, l->position);
+			if (t < min_time)
 			{
-				min_distance = d;
-				result = { l.position.x, l.position.y };
+				min_time = t;
+				result = { l->position.x, l->position.y };
 			}
 		}
 		return result;
 	};
 
-	const auto get_unit = [&] (decltype(unit.id) id) -> Unit const&
-	{
-		for (auto const& u : game.units)
-			if (u.id == id)
-				return u;
-		return unit;
-	};
-
 	const auto point_of_interest = [&] () -> std::optional<std::pair<double, double>> {
 		if ([&] () {
 			if (unit.health < game.properties.unitMaxHealth - game.properties.healthPackHealth / 2.0)
@@ -166,13 +203,13 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 			/*if (!e.has_value())
 				return std::nullopt;
 			auto const& u = get_unit(e.value().second);
-			if (u.weapon == nullptr)
+			if (!u.weapon.has_value())
 				return e.value().first;
 			auto const d_e2 = distance_e2(e.value().first.first, e.value().first.second);
 			constexpr auto min_range_e2 = 100.0;
 			if (min_range_e2 < d_e2)
 				return e.value().first;
-			if (u.weapon->fireTimer == nullptr)
+			if (!u.weapon->fireTimer.has_value())
 				return std::nullopt;
 			DEBUG_DRAW(CustomData::Log("Enemy fire timer: " + std::to_string(*u.weapon->fireTimer)));
 			DEBUG_DRAW(CustomData::Log("Enemy fire rate: " + std::to_string(u.weapon->params.fireRate)));
@@ -192,6 +229,7 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 	};
 
 	auto const poi = point_of_interest();
+	target = poi.has_value() ? Vec2Double(poi.value().first, poi.value().second) : unit.position;
 
 #ifdef _DEBUG
 	if (poi.has_value())
@@ -202,12 +240,10 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 #endif
 
 #ifdef _DEBUG
-	if (unit.weapon != nullptr)
+	if (unit.weapon.has_value())
 		DEBUG_DRAW(CustomData::Log("Spread: " + std::to_string(unit.weapon->spread)));
 #endif
 
-	static std::map<decltype(unit.id), std::pair<double, double>> prev_pos;
-
 	UnitAction action;
 	action.plantMine = [&] () {
 		return false;
@@ -226,12 +262,12 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 			return prev_aim[unit.id];
 		auto delta_x = 0.0;
 		auto delta_y = 0.0;
-		if (unit.weapon != nullptr)
+		if (unit.weapon.has_value())
 		{
 			auto const d = distance_e(e.value().first.first, e.value().first.second);
 			auto const t = std::min(d / unit.weapon->params.bullet.speed * game.properties.ticksPerSecond, 5.0);
-			delta_x = (e.value().first.first - prev_pos[e.value().second].first) * t;
-			delta_y = (e.value().first.second - prev_pos[e.value().second].second) * t;
+			delta_x = (e.value().first.first - m_prev_pos[e.value().second].first) * t;
+			delta_y = (e.value().first.second - m_prev_pos[e.value().second].second) * t;
 		}
 		prev_aim[unit.id] = Vec2Double(e.value().first.first + delta_x - unit.position.x, e.value().first.second + delta_y - unit.position.y - game.properties.unitSize.y / 2.0);
 		DEBUG_DRAW(CustomData::Rect(CV2FW(unit.position.x + prev_aim[unit.id].x, unit.position.y + game.properties.unitSize.y / 2.0 + prev_aim[unit.id].y), CV2FW(0.2, 0.2), ColorFloat(0.0, 1.0, 1.0, 0.5)));
@@ -251,9 +287,9 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 			return true;
 		if (poi.value().second > unit.position.y)
 			return true;
-		if (unit.position.x < poi.value().first - 1.0 && game.level.tiles[static_cast<size_t>(unit.position.x + 1)][static_cast<size_t>(unit.position.y)] == Tile::WALL)
+		if (unit.position.x < poi.value().first - 1.0 && game.level.getTile(static_cast<int>(unit.position.x + 1), static_cast<int>(unit.position.y)) == Tile::WALL)
 			return true;
-		if (unit.position.x > poi.value().first + 1.0 && game.level.tiles[static_cast<size_t>(unit.position.x - 1)][static_cast<size_t>(unit.position.y)] == Tile::WALL)
+		if (unit.position.x > poi.value().first + 1.0 && game.level.getTile(static_cast<int>(unit.position.x - 1), static_cast<int>(unit.position.y)) == Tile::WALL)
 			return true;
 		auto const e = nearest_enemy();
 		if (e.has_value())
@@ -273,19 +309,59 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 			return true;
 		return false;
 	}();
+	// Standing, the unit takes the first move of the shortest route to the
+	// point of interest once the graph is built, and sees the move through to
+	// the node it ends at: it keeps to the move while it rises to the row
+	// under that cell, then steers for it, letting go of jump over it to land.
+	// Otherwise, or once the move takes longer than any edge, it heads
+	// straight for the point.
+	if (auto const graph = context.nav_graph(); graph != nullptr && poi.has_value())
+	{
+		auto found = m_waypoints.find(unit.id);
+		if (found != m_waypoints.end() && game.currentTick > found->second.until)
+		{
+			m_waypoints.erase(found);
+			found = m_waypoints.end();
+		}
+		auto const from = graph->locate(unit);
+		if (unit.onGround || (unit.onLadder && (found == m_waypoints.end() || found->second.node == from)))
+		{
+			auto const route = graph->route(from, graph->locate(target));
+			if (route.ticks != NavGraph::UNREACHABLE && route.first != NavGraph::STAY)
+			{
+				graph->steer(route.first, unit.position, action);
+				m_waypoints[unit.id] = { route.first, static_cast<int>(std::floor(unit.position.x)), route.next, game.currentTick + JumpTable::MAX_TICKS };
+			}
+			else if (found != m_waypoints.end())
+				m_waypoints.erase(found);
+		}
+		else if (found != m_waypoints.end())
+		{
+			auto const& waypoint = found->second;
+			auto const cell = graph->cell(waypoint.node);
+			auto const rising = unit.jumpState.canJump;
+			auto const climbing = rising && unit.position.y < cell.y - 1;
+			auto column = climbing ? waypoint.column : cell.x;
+			if (climbing && (waypoint.move == NavGraph::STEP_LEFT || waypoint.move == NavGraph::JUMP_LEFT))
+				--column;
+			if (climbing && (waypoint.move == NavGraph::STEP_RIGHT || waypoint.move == NavGraph::JUMP_RIGHT))
+				++column;
+			action.velocity = std::clamp((column + 0.5 - unit.position.x) * game.properties.ticksPerSecond, -game.properties.unitMaxHorizontalSpeed, game.properties.unitMaxHorizontalSpeed);
+			if (climbing && (waypoint.move == NavGraph::JUMP_LEFT || waypoint.move == NavGraph::JUMP_RIGHT))
+				graph->steer(waypoint.move, unit.position, action);
+			action.jump = rising && (unit.position.y < cell.y || static_cast<int>(std::floor(unit.position.x)) != cell.x);
+			action.jumpDown = !action.jump && unit.position.y > cell.y + 1;
+		}
+	}
 	action.swapWeapon = [&] () {
-		if (unit.weapon == nullptr)
+		if (!unit.weapon.has_value())
 			return true;
 		if (unit.weapon->typ == best_weapon)
 			return false;
-		for (auto const& l : game.lootBoxes)
+		for (auto const i : game.weaponBoxes[best_weapon])
 		{
-			auto const w = std::dynamic_pointer_cast<const Item::Weapon>(l.item);
-			if (w == nullptr)
-				continue;
-			if (!cross(l.position.x - l.size.x / 2.0, l.position.x + l.size.x / 2.0, l.position.y + l.size.y, l.position.y))
-				continue;
-			if (w->weaponType == best_weapon)
+			auto const& l = game.lootBoxes[i];
+			if (cross(l.position.x - l.size.x / 2.0, l.position.x + l.size.x / 2.0, l.position.y + l.size.y, l.position.y))
 				return true;
 		}
 		return false;
@@ -296,44 +372,27 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 			return false;
 
 		auto const check_aim = [&] (double aim_x, double aim_y) {
-			auto current_x = unit.position.x;
-			auto current_y = unit.position.y + game.properties.unitSize.y / 2.0;
-			auto step_x = aim_x / 1000.0;
-			auto step_y = aim_y / 1000.0;
-			for (int i = 0; i < 1000; ++i)
+			auto const& line_of_fire = context.line_of_fire();
+			auto const bullet_size = unit.weapon.has_value() ? unit.weapon->params.bullet.size : 0.0;
+			Vec2Double const from(unit.position.x, unit.position.y + game.properties.unitSize.y / 2.0);
+			Vec2Double const to(from.x + aim_x, from.y + aim_y);
+			if (!line_of_fire.is_clear(from, to, bullet_size))
+				return false;
+			for (auto const& u : game.units)
 			{
-				auto const current_x_size = static_cast<size_t>(current_x);
-				auto const current_y_size = static_cast<size_t>(current_y);
-				if (current_x_size < 0)
-					return false;
-				if (current_y_size < 0)
-					return false;
-				if (current_x_size > game.level.tiles.size() - 1)
-					return false;
-				if (current_y_size > game.level.tiles[0].size() - 1)
-					return false;
-				if (game.level.tiles[current_x_size][current_y_size] == Tile::WALL)
+				if (u.playerId != unit.playerId)
+					continue;
+				if (u.id == unit.id)
+					continue;
+				if (LineOfFire::unit_hit(from, to, bullet_size, u) <= 1.0)
 					return false;
-				for (auto const& u : game.units)
-				{
-					if (u.playerId != unit.playerId)
-						continue;
-					if (u.id == unit.id)
-						continue;
-					if (u.position.x - u.size.x / 2.0 <= current_x && current_x <= u.position.x + u.size.x / 2.0)
-						return false;
-					if (u.position.y <= current_y && current_y <= u.position.y + u.size.y)
-						return false;
-				}
-				current_x += step_x;
-				current_y += step_y;
 			}
 			return true;
 		};
 
 		auto const spread = [&] () {
-			if (unit.weapon == nullptr)
-				return game.properties.weaponParams.at(WeaponType::ASSAULT_RIFLE).minSpread;
+			if (!unit.weapon.has_value())
+				return game.properties.weaponParams[WeaponType::ASSAULT_RIFLE].minSpread;
 			return unit.weapon->spread;
 		}();
 
@@ -362,7 +421,7 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 	action.reload = [&] () {
 		if (action.shoot)
 			return false;
-		if (unit.weapon == nullptr)
+		if (!unit.weapon.has_value())
 			return false;
 		if (unit.weapon->magazine > unit.weapon->params.magazineSize / 2)
 			return false;
@@ -371,22 +430,12 @@ UnitAction MyStrategy::getAction(Unit const& unit, Game const& game, Debug & deb
 	}();
 	if (action.jump)
 	{
-		if (game.level.tiles[static_cast<size_t>(unit.position.x)][static_cast<size_t>(unit.position.y - 0.5)] == Tile::PLATFORM && game.level.tiles[static_cast<size_t>(unit.position.x)][static_cast<size_t>(unit.position.y)] == Tile::EMPTY && unit.jumpState.maxTime < game.properties.unitJumpTime * 0.8)
+		if (game.level.getTile(static_cast<int>(unit.position.x), static_cast<int>(unit.position.y - 0.5)) == Tile::PLATFORM && game.level.getTile(static_cast<int>(unit.position.x), static_cast<int>(unit.position.y)) == Tile::EMPTY && unit.jumpState.maxTime < game.properties.unitJumpTime * 0.8)
 		{
 			DEBUG_DRAW(CustomData::Log("REJUMP! " + std::to_string(unit.jumpState.maxTime)));
 			action.jump = false;
 		}
 	}
 
-	if (first_unit)
-	{
-		for (auto const& u : game.units)
-		{
-			if (u.playerId == unit.playerId)
-				continue;
-			prev_pos[u.id] = { u.position.x, u.position.y + game.properties.unitSize.y / 2.0 };
-		}
-	}
-
 	return action;
 }
\ No newline at end of file
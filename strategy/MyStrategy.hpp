@@ -2,16 +2,66 @@
 #define _MY_STRATEGY_HPP_
 
 #include "Debug.hpp"
+#include "Navigation.hpp"
+#include "TeamPlanner.hpp"
+#include "ThreadPool.hpp"
+#include "TickContext.hpp"
+#include "WorldState.hpp"
 #include "model/CustomData.hpp"
 #include "model/Game.hpp"
 #include "model/Unit.hpp"
 #include "model/UnitAction.hpp"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 
 class MyStrategy
 {
 public:
-  MyStrategy() = default;
+  // Planning stops this long after planTeam is called; the units' own
+  // actions are scored whatever the budget.
+  static constexpr double DEFAULT_PLAN_BUDGET_MS = 5.0;
+
+  // Rollouts run on the pool, which must outlive the strategy.
+  explicit MyStrategy(ThreadPool & pool,
+                      double planBudgetMs = DEFAULT_PLAN_BUDGET_MS);
+
+  // Plans the moves of all of the player's units for the tick; getAction
+  // then hands out each unit's part, planning first if it hasn't been.
+  void planTeam(Game const& game, int playerId, Debug & debug);
   UnitAction getAction(Unit const& unit, Game const& game, Debug & debug);
+
+private:
+  // What a unit would do on its own, and where it is headed.
+  UnitAction heuristicAction(Unit const& unit, Game const& game, Debug & debug,
+                             Vec2Double & target);
+
+  // Built on the first tick; the level doesn't change during a game. The
+  // navigation is built in the background on the pool, whose jobs share it.
+  std::shared_ptr<World const> m_world;
+  std::shared_ptr<Navigation const> m_navigation;
+  std::unique_ptr<TickContext> m_context;
+  std::unique_ptr<TeamPlanner> m_planner;
+
+  std::vector<TeamPlanner::Member> m_members;
+  std::vector<std::pair<int, UnitAction>> m_planned;
+  int m_planned_tick = -1;
+  std::chrono::microseconds m_plan_budget;
+  ThreadPool* m_pool;
+  // Enemy centers as of the last tick planned, for leading shots.
+  std::map<int, std::pair<double, double>> m_prev_pos;
+  // Each unit's current move on the navigation graph, by unit id: the move,
+  // the column it started from, the node it ends at and the last tick it
+  // is followed.
+  struct Waypoint {
+    NavGraph::Move move;
+    int column;
+    int node;
+    int until;
+  };
+  std::map<int, Waypoint> m_waypoints;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "NavGraph.hpp"
+#include "Simulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+	UnitAction still()
+	{
+		UnitAction action;
+		action.velocity = 0.0;
+		action.jump = false;
+		action.jumpDown = false;
+		action.aim = Vec2Double(0.0, 0.0);
+		action.shoot = false;
+		action.reload = false;
+		action.swapWeapon = false;
+		action.plantMine = false;
+		return action;
+	}
+
+	// Ways to steer that are tried from each row a rising unit reaches.
+	constexpr int BRANCH_DEPTH = 2;
+}
+
+NavGraph::NavGraph(Game const& game)
+	: m_width(game.level.width)
+	, m_height(game.level.height)
+	, m_max_speed(game.properties.unitMaxHorizontalSpeed)
+	, m_ticks_per_column(game.properties.ticksPerSecond / game.properties.unitMaxHorizontalSpeed)
+	, m_jumps(game)
+	, m_node(game.level.width * game.level.height, -1)
+{
+	auto const& level = game.level;
+	auto const& properties = game.properties;
+	for (auto x = 0; x < m_width; ++x)
+	{
+		for (auto y = 0; y < m_height; ++y)
+		{
+			if (!m_jumps.is_standing(x, y))
+				continue;
+			m_node[x * m_height + y] = static_cast<int>(m_cells.size());
+			m_cells.push_back({ static_cast<uint8_t>(x), static_cast<uint8_t>(y) });
+		}
+	}
+	if (m_cells.size() > UINT16_MAX)
+		throw std::runtime_error("Too many cells for the navigation graph");
+
+	// The unit moves alone, as in the jump table.
+	auto world = game;
+	world.units.assign(1, game.units.front());
+	world.bullets.clear();
+	world.mines.clear();
+	auto & unit = world.units.front();
+	auto const prototype = unit;
+	JumpState const ground_jump(true, properties.unitJumpSpeed, properties.unitJumpTime, true);
+	Simulator const simulator(properties, level);
+	auto const limit = JumpTable::MAX_TICKS;
+
+	auto const place = [&] (JumpTable::Cell const& cell) {
+		unit = prototype;
+		unit.position = Vec2Double(cell.x + 0.5, cell.y);
+		unit.jumpState = ground_jump;
+		unit.onGround = true;
+		unit.onLadder = false;
+	};
+
+	std::vector<Edge> edges;
+	m_first.reserve(m_cells.size() + 1);
+	for (auto from = 0; from < static_cast<int>(m_cells.size()); ++from)
+	{
+		auto const start = m_cells[from];
+		edges.clear();
+		auto const add = [&] (JumpTable::Cell const& cell, int ticks, Move move) {
+			auto const to = node(cell.x, cell.y);
+			if (to < 0 || to == from || ticks <= 0)
+				return;
+			auto const found = std::find_if(edges.begin(), edges.end(), [&] (Edge const& edge) { return edge.to == to; });
+			if (found == edges.end())
+				edges.push_back({ static_cast<uint16_t>(to), static_cast<uint8_t>(ticks), static_cast<uint8_t>(move) });
+			else if (ticks < found->ticks)
+				*found = { static_cast<uint16_t>(to), static_cast<uint8_t>(ticks), static_cast<uint8_t>(move) };
+		};
+
+		// Steers the unit to rest in the middle of the column, holding jump
+		// for as long as the jump lasts, and adds where it stops. From each
+		// row it rises through on the way, as after a jump or from a pad, it
+		// also steers into the columns either side, `depth` times over; this
+		// reaches the ledges that full arcs fly past.
+		auto const branch = [&] (auto const& self, int column, bool holding, Move move, int elapsed, int depth) -> void {
+			auto action = still();
+			auto row = JumpTable::floor_cell(unit.position.y);
+			auto climbed = row;
+			for (auto tick = elapsed + 1; tick <= limit; ++tick)
+			{
+				auto const x = unit.position.x;
+				action.velocity = std::clamp((column + 0.5 - x) * properties.ticksPerSecond, -properties.unitMaxHorizontalSpeed, properties.unitMaxHorizontalSpeed);
+				action.jump = holding;
+				simulator.tick(world, &action);
+				// Climbing a ladder, the unit can let go of jump at any row and
+				// hold on there.
+				auto const cell = JumpTable::cell_of(unit.position);
+				if (unit.onLadder && cell.y > climbed)
+				{
+					climbed = cell.y;
+					add(cell, tick, move);
+				}
+				holding = holding && unit.jumpState.canJump && !unit.onGround;
+				if (!holding && (unit.onGround || unit.onLadder) && (std::abs(unit.position.x - column - 0.5) < 1e-6 || unit.position.x == x))
+				{
+					add(cell, tick, move);
+					return;
+				}
+				auto const rising = unit.jumpState.canJump && !unit.onGround && !unit.onLadder;
+				if (depth == 0 || !rising || cell.y <= row)
+					continue;
+				row = cell.y;
+				auto const saved = unit;
+				for (auto const side : { column - 1, column + 1 })
+				{
+					unit = saved;
+					self(self, side, holding, move, tick, depth - 1);
+				}
+				unit = saved;
+			}
+		};
+
+		// Into the next column: walking, walking off a ledge or onto a pad.
+		for (auto const step : { STEP_LEFT, STEP_RIGHT })
+		{
+			place(start);
+			branch(branch, start.x + (step == STEP_LEFT ? -1 : 1), false, step, 0, BRANCH_DEPTH);
+		}
+
+		// Through a platform or down a ladder, to the next place to stand.
+		if (start.y > 0 && !level.isSolid(start.x, start.y - 1))
+		{
+			place(start);
+			auto action = still();
+			action.jumpDown = true;
+			auto tick = 0;
+			while (tick < limit && JumpTable::floor_cell(unit.position.y) >= start.y)
+			{
+				simulator.tick(world, &action);
+				++tick;
+			}
+			if (tick < limit)
+			{
+				branch(branch, start.x, false, DROP, tick, 0);
+			}
+		}
+
+		// Full jumps, stopping on any ladder on the way.
+		for (auto const input : { JumpTable::LEFT, JumpTable::UP, JumpTable::RIGHT })
+		{
+			auto const arc = m_jumps.arc(start.x, start.y, input);
+			auto const move = static_cast<Move>(JUMP_LEFT + input);
+			auto const cells = m_jumps.cells(*arc);
+			for (auto tick = 0; tick + 1 < arc->ticks; ++tick)
+				if (level.isLadder(cells[tick].x, cells[tick].y))
+					add(cells[tick], tick + 1, move);
+			if (arc->lands)
+				add(m_jumps.landing(*arc), arc->ticks, move);
+		}
+
+		// A straight jump, steering sideways from each row it rises through.
+		place(start);
+		branch(branch, start.x, true, JUMP_UP, 0, BRANCH_DEPTH);
+
+		m_first.push_back(static_cast<uint32_t>(m_edges.size()));
+		m_edges.insert(m_edges.end(), edges.begin(), edges.end());
+	}
+	m_first.push_back(static_cast<uint32_t>(m_edges.size()));
+}
+
+int NavGraph::node(int x, int y) const
+{
+	if (x < 0 || x >= m_width || y < 0 || y >= m_height)
+		return -1;
+	return m_node[x * m_height + y];
+}
+
+int NavGraph::locate(Vec2Double const& position) const
+{
+	auto const x = JumpTable::floor_cell(position.x);
+	if (x < 0 || x >= m_width)
+		return -1;
+	for (auto y = std::min(JumpTable::floor_cell(position.y), m_height - 1); y >= 0; --y)
+	{
+		auto const found = m_node[x * m_height + y];
+		if (found >= 0)
+			return found;
+	}
+	return -1;
+}
+
+int NavGraph::locate(Unit const& unit) const
+{
+	auto const found = locate(unit.position);
+	auto const row = JumpTable::floor_cell(unit.position.y);
+	if (!unit.onGround || (found >= 0 && m_cells[found].y == row))
+		return found;
+	for (auto const side : { -unit.size.x / 2.0, unit.size.x / 2.0 })
+	{
+		auto const beside = node(static_cast<int>(std::floor(unit.position.x + side)), row);
+		if (beside >= 0)
+			return beside;
+	}
+	return found;
+}
+
+NavGraph::Paths NavGraph::paths_from(int from) const
+{
+	Paths paths { std::vector<int>(m_cells.size(), UNREACHABLE), std::vector<Move>(m_cells.size(), STAY) };
+	if (from < 0)
+		return paths;
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<>> queue;
+	paths.ticks[from] = 0;
+	queue.emplace(0, from);
+	while (!queue.empty())
+	{
+		auto const [ticks, current] = queue.top();
+		queue.pop();
+		if (ticks > paths.ticks[current])
+			continue;
+		for (auto i = m_first[current]; i < m_first[current + 1]; ++i)
+		{
+			auto const& edge = m_edges[i];
+			auto const next = ticks + edge.ticks;
+			if (next >= paths.ticks[edge.to])
+				continue;
+			paths.ticks[edge.to] = next;
+			paths.first[edge.to] = current == from ? static_cast<Move>(edge.move) : paths.first[current];
+			queue.emplace(next, edge.to);
+		}
+	}
+	return paths;
+}
+
+NavGraph::Route NavGraph::route(int from, int to) const
+{
+	if (from < 0 || to < 0)
+		return { UNREACHABLE, STAY, -1 };
+	if (from == to)
+		return { 0, STAY, -1 };
+	// Units are routed every tick, so the search reuses its buffers; one set
+	// per thread keeps route() safe to call from several.
+	thread_local RouteScratch scratch;
+	auto & ticks = scratch.ticks;
+	auto & first = scratch.first;
+	auto & waypoint = scratch.waypoint;
+	auto & queue = scratch.queue;
+	ticks.assign(m_cells.size(), UNREACHABLE);
+	first.assign(m_cells.size(), STAY);
+	waypoint.assign(m_cells.size(), -1);
+	queue.clear();
+	auto const push = [&] (int estimate, int node) {
+		queue.emplace_back(estimate, node);
+		std::push_heap(queue.begin(), queue.end(), std::greater<>());
+	};
+	ticks[from] = 0;
+	push(heuristic(from, to), from);
+	while (!queue.empty())
+	{
+		std::pop_heap(queue.begin(), queue.end(), std::greater<>());
+		auto const [estimate, current] = queue.back();
+		queue.pop_back();
+		if (current == to)
+			return { ticks[to], first[to], waypoint[to] };
+		if (estimate > ticks[current] + heuristic(current, to))
+			continue;
+		for (auto i = m_first[current]; i < m_first[current + 1]; ++i)
+		{
+			auto const& edge = m_edges[i];
+			auto const next = ticks[current] + edge.ticks;
+			if (next >= ticks[edge.to])
+				continue;
+			ticks[edge.to] = next;
+			first[edge.to] = current == from ? static_cast<Move>(edge.move) : first[current];
+			waypoint[edge.to] = current == from ? edge.to : waypoint[current];
+			push(next + heuristic(edge.to, to), edge.to);
+		}
+	}
+	return { UNREACHABLE, STAY, -1 };
+}
+
+void NavGraph::steer(Move move, Vec2Double const& position, UnitAction & action) const
+{
+	auto const middle = std::floor(position.x) + 0.5;
+	action.velocity = std::clamp((middle - position.x) * m_ticks_per_column * m_max_speed, -m_max_speed, m_max_speed);
+	if (move == STEP_LEFT || move == JUMP_LEFT)
+		action.velocity = -m_max_speed;
+	if (move == STEP_RIGHT || move == JUMP_RIGHT)
+		action.velocity = m_max_speed;
+	action.jump = move == JUMP_LEFT || move == JUMP_UP || move == JUMP_RIGHT;
+	action.jumpDown = move == DROP;
+}
+
+// An edge spans at least half a column per column of its cells apart at
+// full speed, as jumps land off the middle of the column, so counting half
+// never overestimates and A* returns the shortest routes.
+int NavGraph::heuristic(int from, int to) const
+{
+	return static_cast<int>(std::abs(m_cells[from].x - m_cells[to].x) * m_ticks_per_column / 2.0);
+}
@@ -0,0 +1,109 @@
+#ifndef _NAV_GRAPH_HPP_
+#define _NAV_GRAPH_HPP_
+
+#include "JumpTable.hpp"
+#include "model/Game.hpp"
+#include "model/UnitAction.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Where a unit can get to and how long it takes, built once per level. The
+// nodes are the cells a unit stands in (JumpTable::is_standing) and the
+// edges are moves between them weighted in ticks: stepping into the next
+// column, which also covers walking off ledges and onto jump pads,
+// dropping through platforms or down ladders, and jumping with a
+// horizontal input or steering sideways at the top of a straight jump.
+// Every edge was simulated with the Simulator from the unit at rest.
+class NavGraph final
+{
+public:
+	enum Move
+	{
+		STEP_LEFT,
+		STEP_RIGHT,
+		DROP,
+		JUMP_LEFT,
+		JUMP_UP,
+		JUMP_RIGHT,
+		// The unit already is where it is going.
+		STAY
+	};
+
+	static constexpr int UNREACHABLE = std::numeric_limits<int>::max();
+
+	struct Route
+	{
+		int ticks;
+		Move first;
+		// Where the first move ends, or -1.
+		int next;
+	};
+
+	// Shortest routes from one node to all others.
+	struct Paths
+	{
+		std::vector<int> ticks;
+		std::vector<Move> first;
+	};
+
+	explicit NavGraph(Game const& game);
+
+	JumpTable const& jumps() const { return m_jumps; }
+	size_t node_count() const { return m_cells.size(); }
+	JumpTable::Cell cell(int node) const { return m_cells[node]; }
+
+	// The node of a standing cell, or -1.
+	int node(int x, int y) const;
+	// The node something at the position ends up standing on when it falls
+	// straight down, or -1 over a pit.
+	int locate(Vec2Double const& position) const;
+	// The node a unit is at, counting a unit standing on the edge of a block
+	// with its middle over the next column as on the block.
+	int locate(Unit const& unit) const;
+
+	Paths paths_from(int from) const;
+	// A* with the time to cover the horizontal distance at full speed as the
+	// heuristic; ticks is UNREACHABLE when there is no route.
+	Route route(int from, int to) const;
+
+	// The controls that start a move from the position: full speed into the
+	// next column, or back to the middle of this one to go up or down.
+	void steer(Move move, Vec2Double const& position, UnitAction & action) const;
+
+private:
+	struct Edge
+	{
+		uint16_t to;
+		uint8_t ticks;
+		uint8_t move;
+	};
+
+	// The working state of route().
+	struct RouteScratch
+	{
+		std::vector<int> ticks;
+		std::vector<Move> first;
+		std::vector<int> waypoint;
+		// A min-heap of (estimate, node).
+		std::vector<std::pair<int, int>> queue;
+	};
+
+	int heuristic(int from, int to) const;
+
+	int m_width;
+	int m_height;
+	double m_max_speed;
+	double m_ticks_per_column;
+	JumpTable m_jumps;
+	// Cell x * height + y to node.
+	std::vector<int> m_node;
+	std::vector<JumpTable::Cell> m_cells;
+	// The edges of node n are m_edges[m_first[n]] to m_edges[m_first[n + 1]].
+	std::vector<uint32_t> m_first;
+	std::vector<Edge> m_edges;
+};
+
+#endif
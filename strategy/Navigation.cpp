@@ -0,0 +1,28 @@
+#include "Navigation.hpp"
+
+#include <exception>
+
+Navigation::Navigation()
+	: m_built(false)
+{
+}
+
+std::shared_ptr<Navigation const> Navigation::build(Game const& game, ThreadPool & pool)
+{
+	std::shared_ptr<Navigation> navigation(new Navigation());
+	pool.post([navigation, game, &pool] () {
+		// A level the graph can't be built for, too large or without
+		// units, leaves graph() null, and the strategy steers without it.
+		try
+		{
+			navigation->m_graph = std::make_shared<NavGraph const>(game);
+			navigation->m_table = TravelTable::build(navigation->m_graph, pool);
+		}
+		catch (std::exception const&)
+		{
+			return;
+		}
+		navigation->m_built.store(true, std::memory_order_release);
+	});
+	return navigation;
+}
@@ -0,0 +1,41 @@
+#ifndef _NAVIGATION_HPP_
+#define _NAVIGATION_HPP_
+
+#include "NavGraph.hpp"
+#include "ThreadPool.hpp"
+#include "TravelTable.hpp"
+#include "model/Game.hpp"
+
+#include <atomic>
+#include <memory>
+
+// The navigation graph of a level and its travel table, built in the
+// background on the pool so that the first ticks don't wait for them: the
+// graph in one job, then the table by TravelTable::build. Each is null
+// until it is complete, and stays null if building fails.
+class Navigation final
+{
+public:
+	// Starts building for the level of the game. The job shares the result,
+	// so it may be dropped before the build is done.
+	static std::shared_ptr<Navigation const> build(Game const& game, ThreadPool & pool);
+
+	Navigation(Navigation const&) = delete;
+	Navigation & operator = (Navigation const&) = delete;
+
+	NavGraph const* graph() const { return m_built.load(std::memory_order_acquire) ? m_graph.get() : nullptr; }
+	TravelTable const* table() const
+	{
+		return m_built.load(std::memory_order_acquire) && m_table->ready() ? m_table.get() : nullptr;
+	}
+
+private:
+	Navigation();
+
+	std::shared_ptr<NavGraph const> m_graph;
+	std::shared_ptr<TravelTable const> m_table;
+	// Set once both pointers are, which publishes them.
+	std::atomic<bool> m_built;
+};
+
+#endif
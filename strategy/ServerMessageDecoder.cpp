@@ -0,0 +1,220 @@
+#include "ServerMessageDecoder.hpp"
+#include <cstring>
+
+// Compact or grow the buffer when less than this is free at its tail.
+static const size_t MIN_RECEIVE_CAPACITY = 4 * 1024;
+
+void ServerMessageDecoder::SpanInputStream::readBytes(char *buffer,
+                                                      size_t byteCount) {
+  std::memset(buffer, 0, byteCount);
+  windowBegin = windowEnd;
+  underflow = true;
+}
+
+ServerMessageDecoder::ServerMessageDecoder(size_t initialCapacity)
+    : buffer(initialCapacity), begin(0), end(0), required(0),
+      message(nullptr), phase(DONE), index(0) {}
+
+void ServerMessageDecoder::start(ServerMessageGame &message) {
+  this->message = &message;
+  phase = HAS_PLAYER_VIEW;
+  index = 0;
+  required = 0;
+}
+
+char *ServerMessageDecoder::receiveBuffer() {
+  if (buffer.size() - end < MIN_RECEIVE_CAPACITY ||
+      buffer.size() - begin < required) {
+    std::memmove(buffer.data(), buffer.data() + begin, available());
+    end -= begin;
+    begin = 0;
+    size_t capacity = buffer.size();
+    while (capacity - end < MIN_RECEIVE_CAPACITY || capacity < required) {
+      capacity *= 2;
+    }
+    buffer.resize(capacity);
+  }
+  return buffer.data() + end;
+}
+
+size_t ServerMessageDecoder::receiveCapacity() const {
+  return buffer.size() - end;
+}
+
+void ServerMessageDecoder::commit(size_t byteCount) { end += byteCount; }
+
+ServerMessageDecoder::Status ServerMessageDecoder::decode() {
+  while (phase != DONE) {
+    input.reset(buffer.data() + begin, buffer.data() + end);
+    if (!decodeElement()) {
+      return NEED_MORE;
+    }
+    begin = input.position() - buffer.data();
+    required = 0;
+  }
+  return COMPLETE;
+}
+
+bool ServerMessageDecoder::decodeElement() {
+  ServerMessageGame &message = *this->message;
+  switch (phase) {
+  case HAS_PLAYER_VIEW: {
+    bool hasPlayerView = input.readBool();
+    if (input.underflow) {
+      return false;
+    }
+    if (!hasPlayerView) {
+      message.playerView = std::shared_ptr<PlayerView>();
+      phase = DONE;
+    } else {
+      if (!message.playerView) {
+        message.playerView = std::shared_ptr<PlayerView>(new PlayerView());
+      }
+      phase = MY_ID;
+    }
+    return true;
+  }
+  case MY_ID: {
+    int myId = input.readInt();
+    if (input.underflow) {
+      return false;
+    }
+    message.playerView->myId = myId;
+    phase = CURRENT_TICK;
+    return true;
+  }
+  default:
+    break;
+  }
+
+  Game &game = message.playerView->game;
+  switch (phase) {
+  case CURRENT_TICK: {
+    int currentTick = input.readInt();
+    if (input.underflow) {
+      return false;
+    }
+    game.currentTick = currentTick;
+    phase = PROPERTIES;
+    return true;
+  }
+  case PROPERTIES: {
+    size_t decodedSize = game.properties.decodedSize;
+    Properties::readFrom(input, game.properties);
+    if (input.underflow) {
+      // A partial first decode must not be mistaken for a finished one.
+      game.properties.decodedSize = decodedSize;
+      return false;
+    }
+    phase = LEVEL;
+    return true;
+  }
+  case LEVEL: {
+    // The level is decoded in one go once all of it has arrived; its size
+    // follows from the width and the first column height.
+    int width = input.readInt();
+    int height = width > 0 ? input.readInt() : 0;
+    if (input.underflow) {
+      return false;
+    }
+    size_t levelSize =
+        sizeof(int) + static_cast<size_t>(width) * (1 + height) * sizeof(int);
+    if (available() < levelSize) {
+      required = levelSize;
+      return false;
+    }
+    input.reset(buffer.data() + begin, buffer.data() + end);
+    Level::readFrom(input, game.level);
+    phase = PLAYERS_SIZE;
+    return true;
+  }
+  case PLAYERS_SIZE:
+  case UNITS_SIZE:
+  case BULLETS_SIZE:
+  case MINES_SIZE:
+  case LOOT_BOXES_SIZE: {
+    int size = input.readInt();
+    if (input.underflow) {
+      return false;
+    }
+    switch (phase) {
+    case PLAYERS_SIZE:
+      game.players.resize(size);
+      break;
+    case UNITS_SIZE:
+      game.units.resize(size);
+      break;
+    case BULLETS_SIZE:
+      game.bullets.resize(size);
+      break;
+    case MINES_SIZE:
+      game.mines.resize(size);
+      break;
+    default:
+      game.lootBoxes.resize(size);
+      break;
+    }
+    phase = static_cast<Phase>(phase + 1);
+    index = 0;
+    return true;
+  }
+  case PLAYERS:
+    if (index < game.players.size()) {
+      Player player = Player::readFrom(input);
+      if (input.underflow) {
+        return false;
+      }
+      game.players[index++] = player;
+      return true;
+    }
+    phase = UNITS_SIZE;
+    return true;
+  case UNITS:
+    if (index < game.units.size()) {
+      Unit::readFrom(input, game.units[index]);
+      if (input.underflow) {
+        return false;
+      }
+      index++;
+      return true;
+    }
+    phase = BULLETS_SIZE;
+    return true;
+  case BULLETS:
+    if (index < game.bullets.size()) {
+      Bullet::readFrom(input, game.bullets[index]);
+      if (input.underflow) {
+        return false;
+      }
+      index++;
+      return true;
+    }
+    phase = MINES_SIZE;
+    return true;
+  case MINES:
+    if (index < game.mines.size()) {
+      Mine::readFrom(input, game.mines[index]);
+      if (input.underflow) {
+        return false;
+      }
+      index++;
+      return true;
+    }
+    phase = LOOT_BOXES_SIZE;
+    return true;
+  case LOOT_BOXES:
+    if (index < game.lootBoxes.size()) {
+      LootBox::readFrom(input, game.lootBoxes[index]);
+      if (input.underflow) {
+        return false;
+      }
+      index++;
+      return true;
+    }
+    game.indexLootBoxes();
+    phase = DONE;
+    return true;
+  default:
+    return true;
+  }
+}
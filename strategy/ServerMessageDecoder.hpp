@@ -0,0 +1,75 @@
+#ifndef _SERVER_MESSAGE_DECODER_HPP_
+#define _SERVER_MESSAGE_DECODER_HPP_
+
+#include "Stream.hpp"
+#include "model/ServerMessageGame.hpp"
+#include <vector>
+
+// Resumable decoder for ServerMessageGame. Bytes are received into the
+// decoder's own buffer and decoded element by element as they arrive, so
+// most of a snapshot is already in place when its last packet lands.
+// decode() never blocks: when the next element isn't complete yet it
+// returns NEED_MORE and resumes from that element after the next commit().
+class ServerMessageDecoder {
+public:
+  enum Status { NEED_MORE, COMPLETE };
+
+  ServerMessageDecoder(size_t initialCapacity = 64 * 1024);
+  // Starts decoding the next message in place into the given one.
+  void start(ServerMessageGame &message);
+  // Free space for the next receive and the number of bytes it can take.
+  char *receiveBuffer();
+  size_t receiveCapacity() const;
+  void commit(size_t byteCount);
+  Status decode();
+
+private:
+  enum Phase {
+    HAS_PLAYER_VIEW,
+    MY_ID,
+    CURRENT_TICK,
+    PROPERTIES,
+    LEVEL,
+    PLAYERS_SIZE,
+    PLAYERS,
+    UNITS_SIZE,
+    UNITS,
+    BULLETS_SIZE,
+    BULLETS,
+    MINES_SIZE,
+    MINES,
+    LOOT_BOXES_SIZE,
+    LOOT_BOXES,
+    DONE
+  };
+
+  // Reads from the received bytes; running past them flags underflow
+  // instead of blocking.
+  class SpanInputStream : public InputStream {
+  public:
+    SpanInputStream() : underflow(false) {}
+    void reset(const char *begin, const char *end) {
+      windowBegin = begin;
+      windowEnd = end;
+      underflow = false;
+    }
+    const char *position() const { return windowBegin; }
+    void readBytes(char *buffer, size_t byteCount);
+    bool underflow;
+  };
+
+  bool decodeElement();
+  size_t available() const { return end - begin; }
+
+  std::vector<char> buffer;
+  size_t begin;
+  size_t end;
+  // Contiguous bytes the pending element needs, used to grow the buffer.
+  size_t required;
+  SpanInputStream input;
+  ServerMessageGame *message;
+  Phase phase;
+  size_t index;
+};
+
+#endif
@@ -0,0 +1,621 @@
+#include "Simulator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+static_assert(WorldState::MAX_UNITS <= Simulator::MAX_SIMULATED_UNITS, "A WorldState must fit in a tick");
+
+namespace
+{
+	// Boxes that touch a tile boundary or each other exactly don't overlap;
+	// the tolerance absorbs the rounding of positions snapped to a contact.
+	constexpr double EPS = 1e-9;
+
+	// std::floor and std::ceil are library calls without SSE4.1, and these
+	// run several times per unit and microtick.
+	int floor_int(double value)
+	{
+		auto const truncated = static_cast<int>(value);
+		return truncated - (value < truncated ? 1 : 0);
+	}
+
+	int first_cell(double low)
+	{
+		return floor_int(low + EPS);
+	}
+
+	int last_cell(double high)
+	{
+		auto const truncated = static_cast<int>(high - EPS);
+		return truncated - (high - EPS > truncated ? 0 : 1);
+	}
+
+	bool overlap(double low1, double high1, double low2, double high2)
+	{
+		return low1 < high2 - EPS && low2 < high1 - EPS;
+	}
+
+	// Distance from a coordinate to the nearest value at which first_cell or
+	// last_cell of it changes (n - EPS and n + EPS for every integer n),
+	// looking up (1), down (-1) or both ways (0).
+	double boundary_distance(double value, int direction)
+	{
+		auto const below = value - floor_int(value);
+		auto const up = below < EPS ? EPS - below : 1.0 - EPS - below;
+		auto const down = below > 1.0 - EPS ? below - (1.0 - EPS) : below > EPS ? below - EPS : below + EPS;
+		if (direction > 0)
+			return up;
+		if (direction < 0)
+			return down;
+		return std::min(up, down);
+	}
+
+	// Whole steps of the given length that stay clear of a distance, keeping
+	// one step in hand for the rounding of the repeated additions.
+	int steps_within(double distance, double step)
+	{
+		if (step <= 0.0)
+			return std::numeric_limits<int>::max();
+		if (distance <= 0.0)
+			return 0;
+		return std::max(0, static_cast<int>(std::min(distance / step, 1e9)) - 1);
+	}
+}
+
+Simulator::Simulator(Properties const& properties, Level const& level, Stepping stepping)
+	: m_level(&level)
+	, m_line_of_fire(level)
+	, m_stepping(stepping)
+	, m_microticks(properties.updatesPerTick)
+	, m_dt(1.0 / (properties.ticksPerSecond * properties.updatesPerTick))
+	, m_max_speed(properties.unitMaxHorizontalSpeed)
+	, m_fall_speed(properties.unitFallSpeed)
+	, m_max_vertical_speed(std::max({ properties.unitJumpSpeed, properties.jumpPadJumpSpeed, properties.unitFallSpeed }))
+	, m_ground_jump(true, properties.unitJumpSpeed, properties.unitJumpTime, true)
+	, m_pad_jump(true, properties.jumpPadJumpSpeed, properties.jumpPadJumpTime, false)
+	, m_no_jump(false, 0.0, 0.0, false)
+	, m_tick_time(1.0 / properties.ticksPerSecond)
+	, m_mine_trigger_time(properties.mineTriggerTime)
+	, m_weapon_params(properties.weaponParams)
+	, m_mine_size(properties.mineSize)
+	, m_mine_trigger_radius(properties.mineTriggerRadius)
+	, m_mine_explosion(properties.mineExplosionParams)
+{
+}
+
+template <typename State>
+void Simulator::advance(State & state, UnitAction const* actions) const
+{
+	if (state.units.size() > MAX_SIMULATED_UNITS)
+		throw std::runtime_error("Too many units to simulate");
+	std::array<Vec2Double, MAX_SIMULATED_UNITS> starts;
+	for (size_t i = 0; i < state.units.size(); ++i)
+		starts[i] = state.units[i].position;
+
+	if (m_stepping == EVERY_MICROTICK)
+	{
+		for (int i = 0; i < m_microticks; ++i)
+			move_units(state.units, actions);
+	}
+	else
+	{
+		// While the units can't reach each other their microticks are
+		// independent, and each one is advanced through its own events.
+		auto done = 0;
+		while (done < m_microticks)
+		{
+			auto const apart = std::min(apart_microticks(state.units, actions), m_microticks - done);
+			for (size_t i = 0; i < state.units.size(); ++i)
+				advance_alone(state.units, i, actions[i], apart);
+			done += apart;
+			if (done < m_microticks)
+			{
+				move_units(state.units, actions);
+				++done;
+			}
+		}
+	}
+	for (size_t i = 0; i < state.units.size(); ++i)
+	{
+		auto & unit = state.units[i];
+		unit.stand = actions[i].velocity == 0.0;
+		if (actions[i].velocity != 0.0)
+			unit.walkedRight = actions[i].velocity > 0.0;
+	}
+	fly_bullets(state, starts.data());
+	update_mines(state);
+	++state.currentTick;
+}
+
+template <typename Units>
+void Simulator::move_units(Units & units, UnitAction const* actions) const
+{
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		move_horizontally(units, i, std::clamp(actions[i].velocity, -m_max_speed, m_max_speed));
+		move_vertically(units, i, actions[i]);
+	}
+}
+
+void Simulator::tick(Game & game, UnitAction const* actions) const
+{
+	advance(game, actions);
+}
+
+void Simulator::tick(WorldState & state, UnitAction const* actions) const
+{
+	advance(state, actions);
+}
+
+void Simulator::microtick(std::vector<Unit> & units, UnitAction const* actions) const
+{
+	move_units(units, actions);
+}
+
+template <typename Units>
+Simulator::FreeMotion Simulator::free_motion(Units const& units, size_t index, UnitAction const& action) const
+{
+	auto const& unit = units[index];
+	auto const& jump = unit.jumpState;
+	auto const half = unit.size.x / 2.0;
+	FreeMotion motion;
+	motion.on_ladder = on_ladder(unit);
+	motion.stands = stands(units, index, action.jumpDown);
+	motion.on_jump_pad = hits_layer(first_cell(unit.position.x - half), last_cell(unit.position.x + half), first_cell(unit.position.y), last_cell(unit.position.y + unit.size.y), Level::JUMP_PAD_LAYER);
+	motion.steps = std::numeric_limits<int>::max();
+
+	auto const velocity = std::clamp(action.velocity, -m_max_speed, m_max_speed);
+	auto dx = std::abs(velocity) * m_dt;
+	// A unit walking into a wall is snapped back to the same spot every
+	// microtick, so it is as good as standing still.
+	motion.pinned = false;
+	if (velocity != 0.0)
+	{
+		auto const x = unit.position.x + velocity * m_dt;
+		auto const column = velocity > 0.0 ? last_cell(x + half) : first_cell(x - half);
+		auto const current = velocity > 0.0 ? last_cell(unit.position.x + half) : first_cell(unit.position.x - half);
+		auto const snapped = velocity > 0.0 ? column - half : column + 1 + half;
+		motion.pinned = column != current && snapped == unit.position.x
+			&& hits_layer(column, column, first_cell(unit.position.y), last_cell(unit.position.y + unit.size.y), Level::SOLID_LAYER);
+		if (motion.pinned)
+			dx = 0.0;
+	}
+	if (velocity != 0.0 && !motion.pinned)
+	{
+		auto const direction = velocity > 0.0 ? 1 : -1;
+		for (auto const edge : { unit.position.x - half, unit.position.x, unit.position.x + half })
+			motion.steps = std::min(motion.steps, steps_within(boundary_distance(edge, direction), dx));
+	}
+
+	// Bound how fast the unit can go up or down within the window: it rises
+	// while its jump lasts or starts a new one off the ground, a ladder or a
+	// jump pad, and falls unless something holds it.
+	auto const rising = jump.canJump && (action.jump || !jump.canCancel);
+	auto const grounded = motion.on_ladder || motion.stands;
+	auto const holds = (motion.on_ladder && !action.jumpDown) || motion.stands;
+	auto up = 0.0;
+	if (rising)
+		up = jump.speed;
+	if (grounded && action.jump)
+		up = std::max(up, m_ground_jump.speed);
+	if (motion.on_jump_pad)
+		up = std::max(up, m_pad_jump.speed);
+	auto const down = holds ? 0.0 : m_fall_speed;
+	auto const dy_up = up * m_dt;
+	auto const dy_down = down * m_dt;
+	for (auto const edge : { unit.position.y, unit.position.y + unit.size.y / 2.0, unit.position.y + unit.size.y })
+	{
+		motion.steps = std::min(motion.steps, steps_within(boundary_distance(edge, 1), dy_up));
+		motion.steps = std::min(motion.steps, steps_within(boundary_distance(edge, -1), dy_down));
+	}
+	return motion;
+}
+
+// Microticks during which no two units can touch, from how fast each can
+// move at most.
+template <typename Units>
+int Simulator::apart_microticks(Units const& units, UnitAction const* actions) const
+{
+	auto const reach = [&] (size_t index) {
+		auto const dx = std::min(std::abs(actions[index].velocity), m_max_speed) * m_dt;
+		auto const dy = std::max(m_max_vertical_speed, units[index].jumpState.speed) * m_dt;
+		return std::max(dx, dy);
+	};
+	auto steps = std::numeric_limits<int>::max();
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		for (size_t j = i + 1; j < units.size(); ++j)
+		{
+			auto const& a = units[i];
+			auto const& b = units[j];
+			auto const gap_x = std::abs(a.position.x - b.position.x) - (a.size.x + b.size.x) / 2.0;
+			auto const gap_y = std::max(b.position.y - a.position.y - a.size.y, a.position.y - b.position.y - b.size.y);
+			steps = std::min(steps, steps_within(std::max(gap_x, gap_y) - 2.0 * EPS, reach(i) + reach(j)));
+		}
+	}
+	return steps;
+}
+
+// Moves one unit that can't meet any other, with full microticks only where
+// it may touch a tile.
+template <typename Units>
+void Simulator::advance_alone(Units & units, size_t index, UnitAction const& action, int count) const
+{
+	auto done = 0;
+	while (done < count)
+	{
+		auto const motion = free_motion(units, index, action);
+		auto const free = std::min(motion.steps, count - done);
+		skip_microticks(units[index], action, motion, free);
+		done += free;
+		if (done < count)
+		{
+			move_horizontally(units, index, std::clamp(action.velocity, -m_max_speed, m_max_speed));
+			move_vertically(units, index, action);
+			++done;
+		}
+	}
+}
+
+// Replays the branch of move_horizontally and move_vertically that a unit
+// clear of every contact takes, without the lookups.
+template <typename UnitType>
+void Simulator::skip_microticks(UnitType & unit, UnitAction const& action, FreeMotion const& motion, int count) const
+{
+	if (count <= 0)
+		return;
+	auto const velocity = motion.pinned ? 0.0 : std::clamp(action.velocity, -m_max_speed, m_max_speed);
+	auto const holds = (motion.on_ladder && !action.jumpDown) || motion.stands;
+	auto & jump = unit.jumpState;
+	for (auto step = 0; step < count; ++step)
+	{
+		if (velocity != 0.0)
+			unit.position.x = unit.position.x + velocity * m_dt;
+		auto rising = false;
+		if (jump.canJump && (action.jump || !jump.canCancel))
+		{
+			rising = true;
+			unit.position.y = unit.position.y + jump.speed * m_dt;
+			jump.maxTime -= m_dt;
+			if (jump.maxTime <= 0.0)
+				jump = m_no_jump;
+		}
+		else
+		{
+			jump = m_no_jump;
+			if (!holds)
+				unit.position.y = unit.position.y - m_fall_speed * m_dt;
+		}
+		if (motion.on_ladder || (motion.stands && !rising))
+			jump = m_ground_jump;
+		if (motion.on_jump_pad)
+			jump = m_pad_jump;
+	}
+	unit.onLadder = motion.on_ladder;
+	unit.onGround = motion.stands;
+}
+
+// Cells outside the map count as walls.
+bool Simulator::hits_layer(int x_first, int x_last, int y_first, int y_last, uint8_t layer) const
+{
+	if (x_first < 0 || y_first < 0 || x_last >= m_level->width || y_last >= m_level->height)
+	{
+		if (layer & Level::SOLID_LAYER)
+			return true;
+		x_first = std::max(x_first, 0);
+		y_first = std::max(y_first, 0);
+		x_last = std::min(x_last, m_level->width - 1);
+		y_last = std::min(y_last, m_level->height - 1);
+	}
+	for (auto x = x_first; x <= x_last; ++x)
+	{
+		auto const column = m_level->layers.data() + static_cast<size_t>(x) * m_level->height;
+		for (auto y = y_first; y <= y_last; ++y)
+			if (column[y] & layer)
+				return true;
+	}
+	return false;
+}
+
+// A unit holds on to a ladder when its feet or its center are in a ladder tile.
+template <typename UnitType>
+bool Simulator::on_ladder(UnitType const& unit) const
+{
+	auto const x = floor_int(unit.position.x);
+	auto const is_ladder = [&] (double y) {
+		auto const cell = first_cell(y);
+		return m_level->isInside(x, cell) && m_level->isLadder(x, cell);
+	};
+	return is_ladder(unit.position.y) || is_ladder(unit.position.y + unit.size.y / 2.0);
+}
+
+// Walls and other units always carry a unit; platforms and ladder tops only
+// while it isn't dropping through them.
+template <typename Units>
+bool Simulator::stands(Units const& units, size_t index, bool jump_down) const
+{
+	auto const& unit = units[index];
+	auto const left = unit.position.x - unit.size.x / 2.0;
+	auto const right = unit.position.x + unit.size.x / 2.0;
+	auto const row = floor_int(unit.position.y + 0.5);
+	if (std::abs(unit.position.y - row) <= EPS)
+	{
+		auto const layer = jump_down ? Level::SOLID_LAYER : Level::STANDABLE_LAYER;
+		if (hits_layer(first_cell(left), last_cell(right), row - 1, row - 1, layer))
+			return true;
+	}
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		if (i == index)
+			continue;
+		auto const& other = units[i];
+		if (std::abs(other.position.y + other.size.y - unit.position.y) <= EPS
+			&& overlap(left, right, other.position.x - other.size.x / 2.0, other.position.x + other.size.x / 2.0))
+			return true;
+	}
+	return false;
+}
+
+// A microtick moves a unit by a small fraction of a tile and the box it
+// leaves was free, so walls are only looked up in a column or row the box
+// has just entered.
+template <typename Units>
+void Simulator::move_horizontally(Units & units, size_t index, double velocity) const
+{
+	if (velocity == 0.0)
+		return;
+	auto & unit = units[index];
+	auto const half = unit.size.x / 2.0;
+	auto const bottom = unit.position.y;
+	auto const top = bottom + unit.size.y;
+	auto x = unit.position.x + velocity * m_dt;
+	if (velocity > 0.0)
+	{
+		auto const column = last_cell(x + half);
+		if (column != last_cell(unit.position.x + half) && hits_layer(column, column, first_cell(bottom), last_cell(top), Level::SOLID_LAYER))
+			x = column - half;
+	}
+	else
+	{
+		auto const column = first_cell(x - half);
+		if (column != first_cell(unit.position.x - half) && hits_layer(column, column, first_cell(bottom), last_cell(top), Level::SOLID_LAYER))
+			x = column + 1 + half;
+	}
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		if (i == index)
+			continue;
+		auto const& other = units[i];
+		auto const other_half = other.size.x / 2.0;
+		if (!overlap(bottom, top, other.position.y, other.position.y + other.size.y))
+			continue;
+		if (velocity > 0.0 && unit.position.x + half <= other.position.x - other_half + EPS)
+			x = std::min(x, other.position.x - other_half - half);
+		else if (velocity < 0.0 && unit.position.x - half >= other.position.x + other_half - EPS)
+			x = std::max(x, other.position.x + other_half + half);
+	}
+	unit.position.x = x;
+}
+
+template <typename Units>
+void Simulator::move_vertically(Units & units, size_t index, UnitAction const& action) const
+{
+	auto & unit = units[index];
+	auto & jump = unit.jumpState;
+	auto const half = unit.size.x / 2.0;
+	auto const x_first = first_cell(unit.position.x - half);
+	auto const x_last = last_cell(unit.position.x + half);
+	auto const height = unit.size.y;
+	auto rising = false;
+
+	const auto blocked_by_units = [&] (double y) {
+		auto const left = unit.position.x - half;
+		auto const right = unit.position.x + half;
+		for (size_t i = 0; i < units.size(); ++i)
+		{
+			if (i == index)
+				continue;
+			auto const& other = units[i];
+			if (!overlap(left, right, other.position.x - other.size.x / 2.0, other.position.x + other.size.x / 2.0))
+				continue;
+			if (y > unit.position.y && unit.position.y + height <= other.position.y + EPS)
+				y = std::min(y, other.position.y - height);
+			else if (y < unit.position.y && unit.position.y >= other.position.y + other.size.y - EPS)
+				y = std::max(y, other.position.y + other.size.y);
+		}
+		return y;
+	};
+
+	if (jump.canJump && (action.jump || !jump.canCancel))
+	{
+		rising = true;
+		auto y = unit.position.y + jump.speed * m_dt;
+		jump.maxTime -= m_dt;
+		auto blocked = false;
+		auto const row = last_cell(y + height);
+		if (row != last_cell(unit.position.y + height) && hits_layer(x_first, x_last, row, row, Level::SOLID_LAYER))
+		{
+			y = row - height;
+			blocked = true;
+		}
+		auto const free_y = blocked_by_units(y);
+		blocked = blocked || free_y != y;
+		unit.position.y = free_y;
+		if (blocked || jump.maxTime <= 0.0)
+			jump = m_no_jump;
+	}
+	else
+	{
+		jump = m_no_jump;
+		auto const holds_ladder = on_ladder(unit) && !action.jumpDown;
+		if (!holds_ladder && !stands(units, index, action.jumpDown))
+		{
+			auto y = unit.position.y - m_fall_speed * m_dt;
+			// Crossing into a new row means the feet passed the top edge of
+			// its tiles: walls stop the fall, platforms and ladder tops too
+			// unless the unit drops through them.
+			auto const row = first_cell(y);
+			if (row != first_cell(unit.position.y))
+			{
+				auto const layer = action.jumpDown ? Level::SOLID_LAYER : Level::STANDABLE_LAYER;
+				if (hits_layer(x_first, x_last, row, row, layer))
+					y = row + 1;
+			}
+			unit.position.y = blocked_by_units(y);
+		}
+	}
+
+	unit.onLadder = on_ladder(unit);
+	unit.onGround = stands(units, index, action.jumpDown);
+	if (unit.onLadder || (unit.onGround && !rising))
+		jump = m_ground_jump;
+	if (hits_layer(x_first, x_last, first_cell(unit.position.y), last_cell(unit.position.y + height), Level::JUMP_PAD_LAYER))
+		jump = m_pad_jump;
+}
+
+// A bullet stops at the first of a unit other than its shooter, a mine or a
+// wall it reaches during the tick. Units are swept from where they started
+// the tick, in the bullet's frame of reference.
+template <typename State>
+void Simulator::fly_bullets(State & state, Vec2Double const* starts) const
+{
+	auto & bullets = state.bullets;
+	size_t kept = 0;
+	for (size_t i = 0; i < bullets.size(); ++i)
+	{
+		auto & bullet = bullets[i];
+		auto const& params = m_weapon_params[bullet.weaponType];
+		auto const size = params.bullet.size;
+		Vec2Double const to(bullet.position.x + bullet.velocity.x * m_tick_time, bullet.position.y + bullet.velocity.y * m_tick_time);
+		auto hit = m_line_of_fire.wall_hit(bullet.position, to, size);
+		decltype(&state.units[0]) target = nullptr;
+		decltype(&state.mines[0]) mine = nullptr;
+		for (size_t j = 0; j < state.units.size(); ++j)
+		{
+			auto & unit = state.units[j];
+			if (unit.id == bullet.unitId)
+				continue;
+			Vec2Double const from(bullet.position.x - starts[j].x, bullet.position.y - starts[j].y);
+			Vec2Double const relative_to(to.x - unit.position.x, to.y - unit.position.y);
+			auto const t = LineOfFire::box_hit(from, relative_to, size, Vec2Double(0.0, 0.0), unit.size);
+			if (t < hit)
+			{
+				hit = t;
+				target = &unit;
+			}
+		}
+		for (auto & candidate : state.mines)
+		{
+			if (candidate.state == EXPLODED)
+				continue;
+			auto const t = LineOfFire::box_hit(bullet.position, to, size, candidate.position, m_mine_size);
+			if (t < hit)
+			{
+				hit = t;
+				target = nullptr;
+				mine = &candidate;
+			}
+		}
+
+		if (hit > 1.0)
+		{
+			bullet.position = to;
+			if (kept != i)
+				bullets[kept] = std::move(bullet);
+			++kept;
+			continue;
+		}
+		if (target != nullptr)
+			target->health -= params.bullet.damage;
+		if (mine != nullptr)
+			explode_mine(state, *mine);
+		if (params.explosion)
+		{
+			Vec2Double const center(bullet.position.x + (to.x - bullet.position.x) * hit, bullet.position.y + (to.y - bullet.position.y) * hit);
+			explode(state, center, *params.explosion);
+		}
+	}
+	bullets.erase(bullets.begin() + kept, bullets.end());
+}
+
+// Timers run down a tick at a time, and an armed mine is triggered by any
+// unit inside its trigger radius at the end of the tick.
+template <typename State>
+void Simulator::update_mines(State & state) const
+{
+	for (auto & mine : state.mines)
+	{
+		switch (mine.state)
+		{
+		case PREPARING:
+			*mine.timer -= m_tick_time;
+			if (*mine.timer <= 0.0)
+			{
+				mine.state = IDLE;
+				mine.timer.reset();
+			}
+			break;
+		case IDLE:
+		{
+			auto const center_y = mine.position.y + m_mine_size.y / 2.0;
+			auto const radius = m_mine_trigger_radius;
+			auto const triggered = std::any_of(state.units.begin(), state.units.end(), [&] (auto const& unit) {
+				return overlap(unit.position.x - unit.size.x / 2.0, unit.position.x + unit.size.x / 2.0, mine.position.x - radius, mine.position.x + radius)
+					&& overlap(unit.position.y, unit.position.y + unit.size.y, center_y - radius, center_y + radius);
+			});
+			if (triggered)
+			{
+				mine.state = TRIGGERED;
+				mine.timer = m_mine_trigger_time;
+			}
+			break;
+		}
+		case TRIGGERED:
+			*mine.timer -= m_tick_time;
+			if (*mine.timer <= 0.0)
+				explode_mine(state, mine);
+			break;
+		case EXPLODED:
+			break;
+		}
+	}
+	state.mines.erase(std::remove_if(state.mines.begin(), state.mines.end(), [] (auto const& mine) {
+		return mine.state == EXPLODED;
+	}), state.mines.end());
+}
+
+template <typename State, typename MineType>
+void Simulator::explode_mine(State & state, MineType & mine) const
+{
+	mine.state = EXPLODED;
+	mine.timer.reset();
+	explode(state, Vec2Double(mine.position.x, mine.position.y + m_mine_size.y / 2.0), m_mine_explosion);
+}
+
+// Damages every unit the square of the explosion touches, the shooter's
+// included, and sets off the mines it touches in turn. Exploded mines stay
+// in the list until update_mines() drops them, so the chain needs no queue.
+template <typename State>
+void Simulator::explode(State & state, Vec2Double const& center, ExplosionParams const& params) const
+{
+	auto const left = center.x - params.radius;
+	auto const right = center.x + params.radius;
+	auto const bottom = center.y - params.radius;
+	auto const top = center.y + params.radius;
+	for (auto & unit : state.units)
+	{
+		if (overlap(unit.position.x - unit.size.x / 2.0, unit.position.x + unit.size.x / 2.0, left, right)
+			&& overlap(unit.position.y, unit.position.y + unit.size.y, bottom, top))
+			unit.health -= params.damage;
+	}
+	for (auto & mine : state.mines)
+	{
+		if (mine.state != EXPLODED
+			&& overlap(mine.position.x - m_mine_size.x / 2.0, mine.position.x + m_mine_size.x / 2.0, left, right)
+			&& overlap(mine.position.y, mine.position.y + m_mine_size.y, bottom, top))
+			explode_mine(state, mine);
+	}
+}
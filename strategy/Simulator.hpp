@@ -0,0 +1,113 @@
+#ifndef _SIMULATOR_HPP_
+#define _SIMULATOR_HPP_
+
+#include "LineOfFire.hpp"
+#include "WorldState.hpp"
+#include "model/Game.hpp"
+#include "model/UnitAction.hpp"
+
+#include <array>
+#include <vector>
+
+// Deterministic model of the CodeSide unit physics. A tick is split into
+// properties.updatesPerTick microticks; in each of them the units move in
+// order, first horizontally and then vertically, and are stopped flush
+// against walls and other units.
+class Simulator final
+{
+public:
+	// SKIP_TO_EVENTS runs full microticks only where something can happen: a
+	// box edge reaching a tile boundary or units coming into reach of each
+	// other. In between, positions and jump timers are advanced by the same
+	// additions a microtick does, without the tile and unit lookups, so both
+	// modes give bit-identical results; tools/check_stepping.cpp checks
+	// that.
+	enum Stepping
+	{
+		EVERY_MICROTICK,
+		SKIP_TO_EVENTS
+	};
+
+	// Bound on the units for tick(), which keeps their starting positions
+	// on the stack.
+	static constexpr size_t MAX_SIMULATED_UNITS = 16;
+
+	Simulator(Properties const& properties, Level const& level, Stepping stepping = SKIP_TO_EVENTS);
+
+	// Advances the game by one tick; actions[i] drives game.units[i]. Bullets
+	// and mines are resolved once per tick after the units have moved, and
+	// units brought to zero health are left in place for the caller.
+	void tick(Game & game, UnitAction const* actions) const;
+	void tick(WorldState & state, UnitAction const* actions) const;
+	void microtick(std::vector<Unit> & units, UnitAction const* actions) const;
+
+private:
+	// Game and WorldState keep their units, bullets and mines in containers
+	// of different types, and WorldState its units as UnitState; the helpers
+	// take either.
+	template <typename State>
+	void advance(State & state, UnitAction const* actions) const;
+	template <typename Units>
+	void move_units(Units & units, UnitAction const* actions) const;
+
+	// What a unit's microticks depend on besides its position, valid for
+	// `steps` microticks in which none of its box edges crosses a tile
+	// boundary and it stays clear of other units.
+	struct FreeMotion
+	{
+		int steps;
+		bool on_ladder;
+		bool stands;
+		bool on_jump_pad;
+		bool pinned;
+	};
+
+	template <typename Units>
+	FreeMotion free_motion(Units const& units, size_t index, UnitAction const& action) const;
+	template <typename Units>
+	int apart_microticks(Units const& units, UnitAction const* actions) const;
+	template <typename Units>
+	void advance_alone(Units & units, size_t index, UnitAction const& action, int count) const;
+	template <typename UnitType>
+	void skip_microticks(UnitType & unit, UnitAction const& action, FreeMotion const& motion, int count) const;
+	bool hits_layer(int x_first, int x_last, int y_first, int y_last, uint8_t layer) const;
+	template <typename UnitType>
+	bool on_ladder(UnitType const& unit) const;
+	template <typename Units>
+	bool stands(Units const& units, size_t index, bool jump_down) const;
+	template <typename Units>
+	void move_horizontally(Units & units, size_t index, double velocity) const;
+	template <typename Units>
+	void move_vertically(Units & units, size_t index, UnitAction const& action) const;
+	template <typename State>
+	void fly_bullets(State & state, Vec2Double const* starts) const;
+	template <typename State>
+	void update_mines(State & state) const;
+	template <typename State, typename MineType>
+	void explode_mine(State & state, MineType & mine) const;
+	template <typename State>
+	void explode(State & state, Vec2Double const& center, ExplosionParams const& params) const;
+
+	Level const* m_level;
+	LineOfFire m_line_of_fire;
+	Stepping m_stepping;
+	int m_microticks;
+	double m_dt;
+	double m_max_speed;
+	double m_fall_speed;
+	double m_max_vertical_speed;
+	JumpState m_ground_jump;
+	JumpState m_pad_jump;
+	JumpState m_no_jump;
+	double m_tick_time;
+	double m_mine_trigger_time;
+	// A bullet's damage, size and explosion, and a mine's size, trigger
+	// radius and explosion, are taken from here rather than from the
+	// bullet or mine, so that WorldState need not carry them.
+	std::array<WeaponParams, WEAPON_TYPE_COUNT> m_weapon_params;
+	Vec2Double m_mine_size;
+	double m_mine_trigger_radius;
+	ExplosionParams m_mine_explosion;
+};
+
+#endif
@@ -1,109 +1,46 @@
 #include "Stream.hpp"
 #include <algorithm>
 #include <cstring>
-#include <vector>
-
-bool isLittleEndianMachine() {
-  union {
-    unsigned short value;
-    char bytes[2];
-  } test = {0x0201};
-  return test.bytes[0] == 1;
-}
-
-bool IS_LITTLE_ENDIAN_MACHINE = isLittleEndianMachine();
-
-bool InputStream::readBool() {
-  char buffer[1];
-  readBytes(buffer, 1);
-  return buffer[0] != 0;
-}
-
-int InputStream::readInt() {
-  char buffer[sizeof(int)];
-  readBytes(buffer, sizeof(int));
-  if (!IS_LITTLE_ENDIAN_MACHINE) {
-    std::reverse(buffer, buffer + sizeof(int));
-  }
-  return *reinterpret_cast<int *>(buffer);
-}
-
-long long InputStream::readLongLong() {
-  char buffer[sizeof(long long)];
-  readBytes(buffer, sizeof(long long));
-  if (!IS_LITTLE_ENDIAN_MACHINE) {
-    std::reverse(buffer, buffer + sizeof(long long));
-  }
-  return *reinterpret_cast<long long *>(buffer);
-}
-
-float InputStream::readFloat() {
-  char buffer[sizeof(float)];
-  readBytes(buffer, sizeof(float));
-  if (!IS_LITTLE_ENDIAN_MACHINE) {
-    std::reverse(buffer, buffer + sizeof(float));
-  }
-  return *reinterpret_cast<float *>(buffer);
-}
-
-double InputStream::readDouble() {
-  char buffer[sizeof(double)];
-  readBytes(buffer, sizeof(double));
-  if (!IS_LITTLE_ENDIAN_MACHINE) {
-    std::reverse(buffer, buffer + sizeof(double));
-  }
-  return *reinterpret_cast<double *>(buffer);
-}
 
 std::string InputStream::readString() {
-  std::vector<char> buffer(readInt());
-  readBytes(&buffer[0], buffer.size());
-  return std::string(&buffer[0], buffer.size());
-}
-
-void OutputStream::write(bool value) {
-  char buffer[sizeof(bool)];
-  std::memcpy(buffer, &value, sizeof(bool));
-  writeBytes(buffer, sizeof(bool));
-}
-
-void OutputStream::write(int value) {
-  char buffer[sizeof(int)];
-  std::memcpy(buffer, &value, sizeof(int));
-  if (!IS_LITTLE_ENDIAN_MACHINE) {
-    std::reverse(buffer, buffer + sizeof(int));
+  std::string result(static_cast<size_t>(readInt()), '\0');
+  // Through the window like any other read, which streams that serve only
+  // from the window rely on.
+  if (!result.empty()) {
+    readArray(&result[0], result.size());
   }
-  writeBytes(buffer, sizeof(int));
+  return result;
 }
 
-void OutputStream::write(long long value) {
-  char buffer[sizeof(long long)];
-  std::memcpy(buffer, &value, sizeof(long long));
-  if (!IS_LITTLE_ENDIAN_MACHINE) {
-    std::reverse(buffer, buffer + sizeof(long long));
+void InputStream::skipBytes(size_t byteCount) {
+  size_t available = static_cast<size_t>(windowEnd - windowBegin);
+  if (available >= byteCount) {
+    windowBegin += byteCount;
+    return;
   }
-  writeBytes(buffer, sizeof(long long));
-}
-
-void OutputStream::write(float value) {
-  char buffer[sizeof(float)];
-  std::memcpy(buffer, &value, sizeof(float));
-  if (!IS_LITTLE_ENDIAN_MACHINE) {
-    std::reverse(buffer, buffer + sizeof(float));
+  windowBegin = windowEnd;
+  byteCount -= available;
+  char buffer[256];
+  while (byteCount > 0) {
+    size_t chunk = std::min(byteCount, sizeof(buffer));
+    readBytes(buffer, chunk);
+    byteCount -= chunk;
   }
-  writeBytes(buffer, sizeof(float));
 }
 
-void OutputStream::write(double value) {
-  char buffer[sizeof(double)];
-  std::memcpy(buffer, &value, sizeof(double));
-  if (!IS_LITTLE_ENDIAN_MACHINE) {
-    std::reverse(buffer, buffer + sizeof(double));
+size_t InputStream::readSome(char *buffer, size_t capacity) {
+  size_t available = static_cast<size_t>(windowEnd - windowBegin);
+  if (available == 0) {
+    readBytes(buffer, 1);
+    return 1;
   }
-  writeBytes(buffer, sizeof(double));
+  size_t byteCount = std::min(available, capacity);
+  std::memcpy(buffer, windowBegin, byteCount);
+  windowBegin += byteCount;
+  return byteCount;
 }
 
 void OutputStream::write(const std::string &value) {
   write((int)(value.length()));
   writeBytes(value.c_str(), value.length());
-}
\ No newline at end of file
+}
@@ -1,29 +1,103 @@
 #ifndef _STREAM_HPP_
 #define _STREAM_HPP_
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
+// The protocol is little-endian; byte swapping is only compiled in for
+// big-endian targets.
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) &&              \
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define STREAM_BIG_ENDIAN
+#endif
+
+template <typename T> inline T toLittleEndian(T value) {
+#ifdef STREAM_BIG_ENDIAN
+  char *bytes = reinterpret_cast<char *>(&value);
+  std::reverse(bytes, bytes + sizeof(T));
+#endif
+  return value;
+}
+
 class InputStream {
 public:
+  InputStream() : windowBegin(nullptr), windowEnd(nullptr) {}
+  virtual ~InputStream() {}
+  // Slow path: called only when the buffered window can't satisfy a read.
+  // Implementations consume the window first and then refill it.
   virtual void readBytes(char *buffer, size_t byteCount) = 0;
-  bool readBool();
-  int readInt();
-  long long readLongLong();
-  float readFloat();
-  double readDouble();
+  // Reads whatever is available, blocking only until there is at least one
+  // byte. Returns the number of bytes stored.
+  virtual size_t readSome(char *buffer, size_t capacity);
+  template <typename T> T read() {
+    T value;
+    if (static_cast<size_t>(windowEnd - windowBegin) >= sizeof(T)) {
+      std::memcpy(&value, windowBegin, sizeof(T));
+      windowBegin += sizeof(T);
+    } else {
+      readBytes(reinterpret_cast<char *>(&value), sizeof(T));
+    }
+    return toLittleEndian(value);
+  }
+  template <typename T> void readArray(T *values, size_t count) {
+    size_t byteCount = count * sizeof(T);
+    if (static_cast<size_t>(windowEnd - windowBegin) >= byteCount) {
+      std::memcpy(values, windowBegin, byteCount);
+      windowBegin += byteCount;
+    } else {
+      readBytes(reinterpret_cast<char *>(values), byteCount);
+    }
+#ifdef STREAM_BIG_ENDIAN
+    for (size_t i = 0; i < count; i++) {
+      values[i] = toLittleEndian(values[i]);
+    }
+#endif
+  }
+  bool readBool() { return read<char>() != 0; }
+  int readInt() { return read<int>(); }
+  long long readLongLong() { return read<long long>(); }
+  float readFloat() { return read<float>(); }
+  double readDouble() { return read<double>(); }
   std::string readString();
+  void skipBytes(size_t byteCount);
+
+protected:
+  // Contiguous run of already received bytes that the inline readers consume
+  // without a virtual call.
+  const char *windowBegin;
+  const char *windowEnd;
 };
 
 class OutputStream {
 public:
+  OutputStream() : windowBegin(nullptr), windowEnd(nullptr) {}
+  virtual ~OutputStream() {}
+  // Slow path: called only when the free window of the output buffer can't
+  // take a write. Implementations fill the window first and then flush.
   virtual void writeBytes(const char *buffer, size_t byteCount) = 0;
   virtual void flush() = 0;
-  void write(bool value);
-  void write(int value);
-  void write(long long value);
-  void write(float value);
-  void write(double value);
+  template <typename T> void writeValue(T value) {
+    value = toLittleEndian(value);
+    if (static_cast<size_t>(windowEnd - windowBegin) >= sizeof(T)) {
+      std::memcpy(windowBegin, &value, sizeof(T));
+      windowBegin += sizeof(T);
+    } else {
+      writeBytes(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+  }
+  void write(bool value) { writeValue(value); }
+  void write(int value) { writeValue(value); }
+  void write(long long value) { writeValue(value); }
+  void write(float value) { writeValue(value); }
+  void write(double value) { writeValue(value); }
   void write(const std::string &value);
+
+protected:
+  // Free space of the output buffer that the inline writers fill without a
+  // virtual call.
+  char *windowBegin;
+  char *windowEnd;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,16 +1,23 @@
 #include "TcpStream.hpp"
+#include <algorithm>
 #include <cstring>
-#include <iostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #ifdef _WIN32
 typedef int RECV_SEND_T;
 #else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 typedef ssize_t RECV_SEND_T;
 #endif
 
-TcpStream::TcpStream(const std::string &host, int port) {
+TcpStream::TcpStream(const std::string &host, int port,
+                     const Options &options)
+    : options(options) {
 #ifdef _WIN32
   WSADATA wsa_data;
   if (WSAStartup(MAKEWORD(1, 1), &wsa_data) != 0) {
@@ -21,11 +28,13 @@ TcpStream::TcpStream(const std::string &host, int port) {
   if (sock == -1) {
     throw std::runtime_error("Failed to create socket");
   }
+  outputSock = sock;
   int yes = 1;
   if (setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char *)&yes, sizeof(int)) <
       0) {
     throw std::runtime_error("Failed to set TCP_NODELAY");
   }
+  setBufferSizes();
   addrinfo hints, *servinfo;
   std::memset(&hints, 0, sizeof(hints));
   hints.ai_family = AF_INET;
@@ -40,83 +49,227 @@ TcpStream::TcpStream(const std::string &host, int port) {
   freeaddrinfo(servinfo);
 }
 
+TcpStream::TcpStream(SOCKET sock, SOCKET outputSock, const Options &options)
+    : sock(sock), outputSock(outputSock), options(options) {}
+
+// Buffer sizes have to be set before connecting for the TCP window to use
+// them.
+void TcpStream::setBufferSizes() {
+  if (options.receiveBufferSize > 0 &&
+      setsockopt(sock, SOL_SOCKET, SO_RCVBUF,
+                 (char *)&options.receiveBufferSize, sizeof(int)) < 0) {
+    throw std::runtime_error("Failed to set SO_RCVBUF");
+  }
+  if (options.sendBufferSize > 0 &&
+      setsockopt(sock, SOL_SOCKET, SO_SNDBUF, (char *)&options.sendBufferSize,
+                 sizeof(int)) < 0) {
+    throw std::runtime_error("Failed to set SO_SNDBUF");
+  }
+}
+
+#ifndef _WIN32
+std::shared_ptr<TcpStream> TcpStream::connectUnix(const std::string &path,
+                                                  const Options &options) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Unix socket path is too long");
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size());
+  SOCKET sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock == -1) {
+    throw std::runtime_error("Failed to create socket");
+  }
+  std::shared_ptr<TcpStream> stream(new TcpStream(sock, sock, options));
+  stream->setBufferSizes();
+  if (connect(sock, (sockaddr *)&address, sizeof(address)) == -1) {
+    throw std::runtime_error("Failed to connect");
+  }
+  return stream;
+}
+
+std::shared_ptr<TcpStream> TcpStream::fromPipes(int inputFd, int outputFd,
+                                                const Options &options) {
+  std::shared_ptr<TcpStream> stream(
+      new TcpStream(inputFd, outputFd, options));
+#ifdef F_SETPIPE_SZ
+  // Pipe capacity is the counterpart of the socket buffer sizes. Failing to
+  // grow it (e.g. past the system limit, or on a non-pipe) is not fatal.
+  if (options.receiveBufferSize > 0) {
+    fcntl(inputFd, F_SETPIPE_SZ, options.receiveBufferSize);
+  }
+  if (options.sendBufferSize > 0) {
+    fcntl(outputFd, F_SETPIPE_SZ, options.sendBufferSize);
+  }
+#endif
+  return stream;
+}
+#endif
+
+// Receives at least one and at most byteCount bytes.
+static size_t receive(SOCKET sock, char *buffer, size_t byteCount) {
+  while (true) {
+#ifdef _WIN32
+    RECV_SEND_T received = recv(sock, buffer, byteCount, 0);
+#else
+    RECV_SEND_T received = read(sock, buffer, byteCount);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+#endif
+    if (received < 0) {
+      throw std::runtime_error("Failed to read from socket");
+    }
+    if (received == 0) {
+      throw std::runtime_error("Connection closed");
+    }
+    return static_cast<size_t>(received);
+  }
+}
+
+// The received bytes live in InputStream's window, so primitive reads are
+// served inline from the buffer and readBytes only runs at its edges.
 class TcpInputStream : public InputStream {
 public:
   TcpInputStream(std::shared_ptr<TcpStream> tcpStream)
-      : tcpStream(tcpStream), bufferPos(0), bufferSize(0) {}
+      : buffer(tcpStream->options.bufferSize), tcpStream(tcpStream) {
+    windowBegin = this->buffer.data();
+    windowEnd = this->buffer.data();
+  }
   void readBytes(char *buffer, size_t byteCount) {
-    while (byteCount > 0) {
-      if (bufferSize > 0) {
-        if (bufferSize >= byteCount) {
-          memcpy(buffer, this->buffer + bufferPos, byteCount);
-          bufferPos += byteCount;
-          bufferSize -= byteCount;
-          return;
+    size_t available = windowEnd - windowBegin;
+    size_t byteCountFromWindow = std::min(available, byteCount);
+    memcpy(buffer, windowBegin, byteCountFromWindow);
+    windowBegin += byteCountFromWindow;
+    buffer += byteCountFromWindow;
+    byteCount -= byteCountFromWindow;
+    if (byteCount == 0) {
+      return;
+    }
+    windowBegin = this->buffer.data();
+    windowEnd = this->buffer.data();
+#ifdef _WIN32
+    // Bulk reads bypass the buffer and wait for the whole block at once.
+    if (byteCount >= this->buffer.size()) {
+      while (byteCount > 0) {
+        RECV_SEND_T received =
+            recv(tcpStream->sock, buffer, byteCount, MSG_WAITALL);
+        if (received < 0) {
+          throw std::runtime_error("Failed to read from socket");
+        }
+        if (received == 0) {
+          throw std::runtime_error("Connection closed");
         }
-        memcpy(buffer, this->buffer + bufferPos, bufferSize);
-        buffer += bufferSize;
-        byteCount -= bufferSize;
-        bufferPos += bufferSize;
-        bufferSize = 0;
+        buffer += received;
+        byteCount -= received;
       }
-      if (bufferPos == BUFFER_CAPACITY) {
-        bufferPos = 0;
+      return;
+    }
+    while (byteCount > 0) {
+      size_t received =
+          receive(tcpStream->sock, this->buffer.data(), this->buffer.size());
+      size_t byteCountFromWindow = std::min(received, byteCount);
+      memcpy(buffer, this->buffer.data(), byteCountFromWindow);
+      buffer += byteCountFromWindow;
+      byteCount -= byteCountFromWindow;
+      windowBegin = this->buffer.data() + byteCountFromWindow;
+      windowEnd = this->buffer.data() + received;
+    }
+#else
+    // One readv fills the caller's memory directly and whatever follows it
+    // lands in the buffer, so bulk reads skip the extra copy and small ones
+    // still read ahead.
+    while (byteCount > 0) {
+      iovec parts[2];
+      parts[0].iov_base = buffer;
+      parts[0].iov_len = byteCount;
+      parts[1].iov_base = this->buffer.data();
+      parts[1].iov_len = this->buffer.size();
+      RECV_SEND_T received = readv(tcpStream->sock, parts, 2);
+      if (received < 0 && errno == EINTR) {
+        continue;
       }
-      RECV_SEND_T received =
-          recv(tcpStream->sock, this->buffer + bufferPos + bufferSize,
-               BUFFER_CAPACITY - bufferPos - bufferSize, 0);
       if (received < 0) {
         throw std::runtime_error("Failed to read from socket");
       }
-      bufferSize += received;
+      if (received == 0) {
+        throw std::runtime_error("Connection closed");
+      }
+      if (static_cast<size_t>(received) < byteCount) {
+        buffer += received;
+        byteCount -= received;
+      } else {
+        windowEnd = this->buffer.data() + (received - byteCount);
+        byteCount = 0;
+      }
+    }
+#endif
+  }
+  size_t readSome(char *buffer, size_t capacity) {
+    size_t available = windowEnd - windowBegin;
+    if (available > 0) {
+      size_t byteCount = std::min(available, capacity);
+      memcpy(buffer, windowBegin, byteCount);
+      windowBegin += byteCount;
+      return byteCount;
     }
+    // Nothing buffered: receive straight into the caller's memory.
+    return receive(tcpStream->sock, buffer, capacity);
   }
 
 private:
-  static const size_t BUFFER_CAPACITY = 8 * 1024;
-  char buffer[BUFFER_CAPACITY];
-  size_t bufferPos;
-  size_t bufferSize;
+  std::vector<char> buffer;
   std::shared_ptr<TcpStream> tcpStream;
 };
 
+// The free part of the buffer is OutputStream's window, so primitive writes
+// go straight into it and writeBytes only runs when the buffer is full.
 class TcpOutputStream : public OutputStream {
 public:
   TcpOutputStream(std::shared_ptr<TcpStream> tcpStream)
-      : tcpStream(tcpStream), bufferPos(0), bufferSize(0) {}
+      : buffer(tcpStream->options.bufferSize), tcpStream(tcpStream) {
+    windowBegin = this->buffer.data();
+    windowEnd = this->buffer.data() + this->buffer.size();
+  }
   void writeBytes(const char *buffer, size_t byteCount) {
     while (byteCount > 0) {
-      size_t capacity = BUFFER_CAPACITY - bufferPos - bufferSize;
+      size_t capacity = windowEnd - windowBegin;
       if (capacity >= byteCount) {
-        memcpy(this->buffer + bufferPos + bufferSize, buffer, byteCount);
-        bufferSize += byteCount;
+        memcpy(windowBegin, buffer, byteCount);
+        windowBegin += byteCount;
         return;
       }
-      memcpy(this->buffer + bufferPos + bufferSize, buffer, capacity);
-      bufferSize += capacity;
+      memcpy(windowBegin, buffer, capacity);
+      windowBegin += capacity;
       byteCount -= capacity;
       buffer += capacity;
       flush();
     }
   }
   void flush() {
-    while (bufferSize > 0) {
+    const char *pending = this->buffer.data();
+    while (pending < windowBegin) {
+#ifdef _WIN32
+      RECV_SEND_T sent =
+          send(tcpStream->outputSock, pending, windowBegin - pending, 0);
+#else
       RECV_SEND_T sent =
-          send(tcpStream->sock, buffer + bufferPos, bufferSize, 0);
+          ::write(tcpStream->outputSock, pending, windowBegin - pending);
+      if (sent < 0 && errno == EINTR) {
+        continue;
+      }
+#endif
       if (sent < 0) {
         throw std::runtime_error("Failed to write to socket");
       }
-      bufferPos += sent;
-      bufferSize -= sent;
+      pending += sent;
     }
-    bufferPos = 0;
+    windowBegin = this->buffer.data();
   }
 
 private:
-  static const size_t BUFFER_CAPACITY = 8 * 1024;
-  char buffer[BUFFER_CAPACITY];
-  size_t bufferPos;
-  size_t bufferSize;
+  std::vector<char> buffer;
   std::shared_ptr<TcpStream> tcpStream;
 };
 
@@ -20,10 +20,37 @@ typedef int SOCKET;
 #include <memory>
 #include <string>
 
+// Connection to the game server. Sockets use one descriptor both ways; the
+// pipe backend reads and writes through separate ones.
 class TcpStream {
 public:
-  TcpStream(const std::string &host, int port);
+  struct Options {
+    Options() : receiveBufferSize(0), sendBufferSize(0), bufferSize(64 * 1024) {}
+    // Kernel SO_RCVBUF/SO_SNDBUF sizes; 0 keeps the system default.
+    int receiveBufferSize;
+    int sendBufferSize;
+    // Size of each of the user space input and output buffers.
+    size_t bufferSize;
+  };
+
+  TcpStream(const std::string &host, int port,
+            const Options &options = Options());
+#ifndef _WIN32
+  // Unix-domain stream socket, for a server running on the same machine.
+  static std::shared_ptr<TcpStream>
+  connectUnix(const std::string &path, const Options &options = Options());
+  // Already open descriptors, e.g. stdin/stdout of a local arena.
+  static std::shared_ptr<TcpStream>
+  fromPipes(int inputFd, int outputFd, const Options &options = Options());
+#endif
+
   SOCKET sock;
+  SOCKET outputSock;
+  Options options;
+
+private:
+  TcpStream(SOCKET sock, SOCKET outputSock, const Options &options);
+  void setBufferSizes();
 };
 
 std::shared_ptr<InputStream>
@@ -32,4 +59,4 @@ getInputStream(std::shared_ptr<TcpStream> tcpStream);
 std::shared_ptr<OutputStream>
 getOutputStream(std::shared_ptr<TcpStream> tcpStream);
 
-#endif
\ No newline at end of file
+#endif
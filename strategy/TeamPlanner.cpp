@@ -0,0 +1,400 @@
+#include "TeamPlanner.hpp"
+#include "LineOfFire.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+
+namespace
+{
+	// A point of damage taken weighs as much as this many ticks of travel.
+	constexpr double DAMAGE_WEIGHT = 4.0;
+	// Per tick one of our units stands between an ally and its target.
+	constexpr double BLOCK_WEIGHT = 2.0;
+	// A point of damage from a bullet that arrives after the horizon; by then
+	// the unit may well have moved on.
+	constexpr double LATE_DAMAGE_WEIGHT = 2.0;
+
+	static_assert(TeamPlanner::HORIZON <= TickContext::DANGER_HORIZON, "The rollouts must fit in the bullet traces");
+	// A dodge is held this long before the unit goes back to its own action.
+	constexpr int DODGE_TICKS = 6;
+	// Changes that fail to improve on the current plans before the search
+	// starts over from random ones.
+	constexpr int STALL_LIMIT = 48;
+
+	TeamPlanner::Control control_of(UnitAction const& action)
+	{
+		return { action.velocity, action.jump, action.jumpDown };
+	}
+
+	void apply(TeamPlanner::Control const& control, UnitAction & action)
+	{
+		action.velocity = control.velocity;
+		action.jump = control.jump;
+		action.jumpDown = control.jump_down;
+	}
+
+	TeamPlanner::Plan hold(TeamPlanner::Control const& control)
+	{
+		return { { { { control, TeamPlanner::HORIZON }, { control, 0 }, { control, 0 } } } };
+	}
+
+	Vec2Double center(UnitState const& unit)
+	{
+		return Vec2Double(unit.position.x, unit.position.y + unit.size.y / 2.0);
+	}
+}
+
+TeamPlanner::Control const& TeamPlanner::Plan::at(int tick) const
+{
+	for (auto const& segment : segments)
+	{
+		if (tick < segment.ticks)
+			return segment.control;
+		tick -= segment.ticks;
+	}
+	return segments.back().control;
+}
+
+TeamPlanner::Plan TeamPlanner::Plan::shifted(int ticks) const
+{
+	// The segments left keep their order and the spent ones make way at the
+	// end for the last control, which still runs on past them.
+	auto plan = *this;
+	size_t kept = 0;
+	for (auto segment : segments)
+	{
+		auto const spent = std::min(ticks, segment.ticks);
+		ticks -= spent;
+		segment.ticks -= spent;
+		if (segment.ticks > 0)
+			plan.segments[kept++] = segment;
+	}
+	for (; kept < SEGMENTS; ++kept)
+		plan.segments[kept] = { segments.back().control, 0 };
+	return plan;
+}
+
+TeamPlanner::TeamPlanner(World const& world, TickContext & context, ThreadPool & pool)
+	: m_context(&context)
+	, m_pool(&pool)
+	, m_simulator(world.properties, world.level)
+	, m_bullets(nullptr)
+	, m_rollouts(0)
+	, m_elite_tick(0)
+{
+	auto const speed = world.properties.unitMaxHorizontalSpeed;
+	for (auto const velocity : { -speed, 0.0, speed })
+	{
+		m_controls.push_back({ velocity, false, false });
+		m_controls.push_back({ velocity, true, false });
+		m_controls.push_back({ velocity, false, true });
+	}
+}
+
+void TeamPlanner::plan(Game const& game, std::vector<Member> & members, Clock::time_point deadline)
+{
+	m_rollouts = 0;
+	// With more units than a WorldState holds the members keep the actions
+	// they came with.
+	if (members.empty() || !WorldState::fits(game))
+		return;
+	// Beyond WorldState::MAX_BULLETS and MAX_MINES, the bullets and mines
+	// furthest from the units are not in the rollouts.
+	WorldState const start(game);
+
+	UnitAction still;
+	still.velocity = 0.0;
+	still.jump = false;
+	still.jumpDown = false;
+	still.aim = Vec2Double(0.0, 0.0);
+	still.shoot = false;
+	still.reload = false;
+	still.swapWeapon = false;
+	still.plantMine = false;
+	m_scratch.resize(m_pool->size());
+	for (auto & scratch : m_scratch)
+	{
+		scratch.actions.assign(game.units.size(), still);
+		scratch.trajectories.resize(members.size() * TickContext::DANGER_HORIZON);
+	}
+	m_bullets = &m_context->bullets();
+
+	m_plans.clear();
+	m_targets.clear();
+	for (auto const& member : members)
+	{
+		m_plans.push_back(hold(control_of(member.action)));
+		auto const enemy = m_context->nearest_enemy(game.units[member.index]);
+		m_targets.push_back(enemy != nullptr ? static_cast<int>(enemy - game.units.data()) : -1);
+	}
+
+	// Batches are scored on the pool once the travel times can be read from
+	// several threads. Each joint plan is scored on its own and the batch is
+	// reduced in order, so the outcome doesn't depend on the threads.
+	auto const parallel = m_context->travel_time_concurrent();
+	// Wrapped once per tick rather than once per batch.
+	ThreadPool::Task const task = [&] (size_t index, unsigned thread) {
+		m_values[index] = score(start, members, m_batch[index], m_scratch[thread]);
+	};
+	auto const best_of_batch = [&] (size_t count) {
+		m_values.resize(count);
+		if (parallel)
+			m_pool->run(count, task);
+		else
+			for (size_t i = 0; i < count; ++i)
+				task(i, 0);
+		m_rollouts += static_cast<int>(count);
+		for (size_t i = 0; i < count; ++i)
+			remember(m_values[i], m_batch[i]);
+		return static_cast<size_t>(std::max_element(m_values.begin(), m_values.begin() + count) - m_values.begin());
+	};
+	auto const batch_slot = [&] (size_t index) -> std::vector<Plan> & {
+		if (m_batch.size() <= index)
+			m_batch.resize(index + 1);
+		return m_batch[index];
+	};
+
+	carry_over(game, members);
+
+	// The units' own actions are scored even past the deadline, so there is
+	// always a plan to fall back on.
+	batch_slot(0) = m_plans;
+	auto best = m_values[best_of_batch(1)];
+	auto const expired = [&] () { return Clock::now() >= deadline; };
+
+	// A sweep of constant controls for each unit in turn, against the
+	// current plans of the others, and of short dodges for the units that
+	// the bullets in flight would hit if they kept still. The plans carried
+	// over from the last tick lead the sweep of the first unit. Candidates
+	// are scored BATCH at a time, so the sweep stops within a batch of the
+	// deadline.
+	for (size_t i = 0; i < members.size() && !expired(); ++i)
+	{
+		auto const own = control_of(members[i].action);
+		auto const danger = m_context->danger(game.units[members[i].index]);
+		auto const threatened = std::any_of(danger, danger + TickContext::DANGER_HORIZON, [] (int damage) { return damage > 0; });
+		auto const carried = i == 0 ? m_carried.size() : 0;
+		auto const per_control = threatened ? size_t(2) : size_t(1);
+		auto const candidates = carried + m_controls.size() * per_control;
+		for (size_t next = 0; next < candidates && !expired(); )
+		{
+			size_t count = 0;
+			for (; count < BATCH && next < candidates; ++count, ++next)
+			{
+				auto & joint = batch_slot(count);
+				if (next < carried)
+				{
+					joint = m_carried[next];
+					continue;
+				}
+				auto const& control = m_controls[(next - carried) / per_control];
+				joint = m_plans;
+				if ((next - carried) % per_control == 0)
+					joint[i] = hold(control);
+				else
+					joint[i] = { { { { control, DODGE_TICKS }, { own, HORIZON }, { own, 0 } } } };
+			}
+			auto const chosen = best_of_batch(count);
+			if (m_values[chosen] > best)
+			{
+				best = m_values[chosen];
+				m_plans = m_batch[chosen];
+			}
+		}
+	}
+
+	// Then hill climbing on the segments of the plans for as long as the
+	// budget lasts, BATCH changes at a time, restarting from random plans
+	// when it stalls. The seed depends on the tick only, so the plans depend
+	// on the time left only through how many batches the search gets to.
+	m_random.seed(static_cast<std::mt19937::result_type>(game.currentTick));
+	m_current = m_plans;
+	auto current = best;
+	auto stalled = 0;
+	while (!expired())
+	{
+		if (stalled >= STALL_LIMIT)
+		{
+			auto & joint = batch_slot(0);
+			joint = m_current;
+			for (auto & plan : joint)
+				for (auto & segment : plan.segments)
+					segment = random_segment();
+			best_of_batch(1);
+			m_current = joint;
+			current = m_values[0];
+			stalled = 0;
+		}
+		else
+		{
+			for (size_t k = 0; k < BATCH; ++k)
+			{
+				auto & joint = batch_slot(k);
+				joint = m_current;
+				mutate(members, joint);
+			}
+			auto const chosen = best_of_batch(BATCH);
+			if (m_values[chosen] > current)
+			{
+				m_current = m_batch[chosen];
+				current = m_values[chosen];
+				stalled = 0;
+			}
+			else
+			{
+				stalled += static_cast<int>(BATCH);
+				continue;
+			}
+		}
+		if (current > best)
+		{
+			best = current;
+			m_plans = m_current;
+		}
+	}
+
+	for (size_t i = 0; i < members.size(); ++i)
+		apply(m_plans[i].at(0), members[i].action);
+}
+
+// Moves the plans kept from the last tick on to this one as m_carried,
+// matched to the members by unit id. Units that have died since drop out of
+// them and new ones follow their own action. Starts keeping the plans of
+// this tick.
+void TeamPlanner::carry_over(Game const& game, std::vector<Member> const& members)
+{
+	size_t count = 0;
+	auto const elapsed = game.currentTick - m_elite_tick;
+	if (elapsed > 0 && elapsed < HORIZON)
+	{
+		for (auto const& scored : m_elite)
+		{
+			if (m_carried.size() <= count)
+				m_carried.resize(count + 1);
+			auto & joint = m_carried[count];
+			joint.clear();
+			auto matched = false;
+			for (auto const& member : members)
+			{
+				auto const id = game.units[member.index].id;
+				auto const found = std::find(m_elite_ids.begin(), m_elite_ids.end(), id);
+				if (found != m_elite_ids.end())
+				{
+					joint.push_back(scored.plans[found - m_elite_ids.begin()].shifted(elapsed));
+					matched = true;
+				}
+				else
+					joint.push_back(hold(control_of(member.action)));
+			}
+			if (matched)
+				++count;
+		}
+	}
+	m_carried.resize(count);
+
+	m_elite.clear();
+	m_elite_ids.clear();
+	for (auto const& member : members)
+		m_elite_ids.push_back(game.units[member.index].id);
+	m_elite_tick = game.currentTick;
+}
+
+// Keeps the joint plan if it is among the CARRIED best of the tick. Plans
+// that score the same as one already kept are taken to be the same plan.
+void TeamPlanner::remember(double value, std::vector<Plan> const& plans)
+{
+	auto const place = static_cast<size_t>(std::find_if(m_elite.begin(), m_elite.end(), [value] (Scored const& scored) { return scored.value <= value; }) - m_elite.begin());
+	if (place >= CARRIED || (place < m_elite.size() && m_elite[place].value == value))
+		return;
+	// The ones below move down a place, and the last falls off when full.
+	if (!m_elite.full())
+		m_elite.push_back(Scored());
+	for (auto i = m_elite.size() - 1; i > place; --i)
+		m_elite[i] = m_elite[i - 1];
+	auto & scored = m_elite[place];
+	scored.value = value;
+	scored.plans.clear();
+	for (auto const& plan : plans)
+		scored.plans.push_back(plan);
+}
+
+TeamPlanner::Plan::Segment TeamPlanner::random_segment()
+{
+	auto const control = m_controls[std::uniform_int_distribution<size_t>(0, m_controls.size() - 1)(m_random)];
+	return { control, std::uniform_int_distribution<int>(1, HORIZON / 2)(m_random) };
+}
+
+// Changes the control or the length of one segment of one unit's plan, or
+// puts the unit's own action in as the control.
+void TeamPlanner::mutate(std::vector<Member> const& members, std::vector<Plan> & plans)
+{
+	auto & plan = plans[std::uniform_int_distribution<size_t>(0, members.size() - 1)(m_random)];
+	auto const which = std::uniform_int_distribution<size_t>(0, SEGMENTS - 1)(m_random);
+	auto & segment = plan.segments[which];
+	switch (std::uniform_int_distribution<int>(0, 2)(m_random))
+	{
+	case 0:
+		segment.control = random_segment().control;
+		break;
+	case 1:
+		segment.ticks = random_segment().ticks;
+		break;
+	default:
+		segment.control = control_of(members[&plan - plans.data()].action);
+		break;
+	}
+}
+
+double TeamPlanner::score(WorldState const& start, std::vector<Member> const& members, std::vector<Plan> const& plans, Scratch & scratch) const
+{
+	auto & actions = scratch.actions;
+	auto state = start;
+	auto blocked = 0;
+	for (auto tick = 0; tick < HORIZON; ++tick)
+	{
+		for (size_t i = 0; i < members.size(); ++i)
+			apply(plans[i].at(tick), actions[members[i].index]);
+		m_simulator.tick(state, actions.data());
+
+		for (size_t i = 0; i < members.size(); ++i)
+		{
+			scratch.trajectories[i * TickContext::DANGER_HORIZON + tick] = state.units[members[i].index].position;
+			if (m_targets[i] < 0)
+				continue;
+			auto const from = center(state.units[members[i].index]);
+			auto const to = center(state.units[m_targets[i]]);
+			for (size_t j = 0; j < members.size(); ++j)
+			{
+				auto const& other = state.units[members[j].index];
+				if (j != i && LineOfFire::box_hit(from, to, 0.0, other.position, other.size) <= 1.0)
+					++blocked;
+			}
+		}
+	}
+
+	auto value = -BLOCK_WEIGHT * blocked;
+	for (size_t i = 0; i < members.size(); ++i)
+	{
+		auto const& member = members[i];
+		auto const& unit = state.units[member.index];
+		value -= DAMAGE_WEIGHT * (start.units[member.index].health - unit.health);
+		// The bullets the rollout has played out are taken out of the
+		// timeline, and those left are traced against the unit waiting where
+		// it stopped.
+		if (unit.health > 0 && m_bullets->bullet_count() > 0)
+		{
+			auto const trajectory = scratch.trajectories.data() + i * TickContext::DANGER_HORIZON;
+			std::fill(trajectory + HORIZON, trajectory + TickContext::DANGER_HORIZON, unit.position);
+			std::array<int, TickContext::DANGER_HORIZON> timeline {};
+			m_bullets->damage_along(member.index, trajectory, TickContext::DANGER_HORIZON, timeline.data());
+			value -= LATE_DAMAGE_WEIGHT * std::accumulate(timeline.begin() + HORIZON, timeline.end(), 0);
+		}
+		// Every plan is as far from a target out of reach.
+		auto const travel = m_context->travel_time(unit.position, member.target);
+		if (std::isfinite(travel))
+			value -= travel;
+	}
+	return value;
+}
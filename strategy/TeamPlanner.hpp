@@ -0,0 +1,137 @@
+#ifndef _TEAM_PLANNER_HPP_
+#define _TEAM_PLANNER_HPP_
+
+#include "BulletSimulator.hpp"
+#include "FixedVector.hpp"
+#include "Simulator.hpp"
+#include "ThreadPool.hpp"
+#include "TickContext.hpp"
+#include "WorldState.hpp"
+#include "model/Game.hpp"
+#include "model/UnitAction.hpp"
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Movement for all of our units at once. Candidate plans are scored by
+// rolling one copy of the world forward with the Simulator: the enemies keep
+// still, the bullets in flight and the mines play out, and each unit is
+// judged on the damage it takes, how close it ends up to its target and how
+// long it stands in the line of fire of an ally. Bullets that would still
+// hit a unit staying where the plan leaves it count too, at a lower weight.
+//
+// The search is anytime: after a sweep of simple candidates it keeps
+// improving the plans by random changes until a deadline, and returns the
+// best joint plan it has scored. The best few joint plans of a tick, moved
+// on by the ticks that have passed, are scored again with the first sweep
+// of the next one, so a search picks up where the last one stopped.
+class TeamPlanner final
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr int HORIZON = 20;
+	static constexpr size_t SEGMENTS = 3;
+	// Changes to the plans scored at once while hill climbing; fixed, so the
+	// search takes the same steps with any number of threads.
+	static constexpr size_t BATCH = 8;
+	// Joint plans carried over to the next tick.
+	static constexpr size_t CARRIED = 4;
+
+	struct Control
+	{
+		double velocity;
+		bool jump;
+		bool jump_down;
+	};
+
+	// Controls held for a number of ticks each; the last one runs to the end
+	// of the horizon.
+	struct Plan
+	{
+		struct Segment
+		{
+			Control control;
+			int ticks;
+		};
+
+		std::array<Segment, SEGMENTS> segments;
+
+		Control const& at(int tick) const;
+		// The same plan started `ticks` ticks later.
+		Plan shifted(int ticks) const;
+	};
+
+	// One of our units: game.units[index], the action the strategy would take
+	// on its own, and where it is headed. The planner replaces the movement
+	// part of the action.
+	struct Member
+	{
+		size_t index;
+		UnitAction action;
+		Vec2Double target;
+	};
+
+	// Rollouts are spread over the pool.
+	TeamPlanner(World const& world, TickContext & context, ThreadPool & pool);
+
+	void plan(Game const& game, std::vector<Member> & members, Clock::time_point deadline);
+
+	// Joint plans scored by the last call to plan().
+	int rollouts() const { return m_rollouts; }
+
+private:
+	// A joint plan kept across ticks, inline so that keeping one doesn't
+	// allocate; plan() only runs for as many units as a WorldState holds.
+	struct Scored
+	{
+		double value;
+		FixedVector<Plan, WorldState::MAX_UNITS> plans;
+	};
+
+	// What one thread of the pool writes while scoring: the actions of all
+	// units and the path of each member, TickContext::DANGER_HORIZON
+	// positions per member.
+	struct Scratch
+	{
+		std::vector<UnitAction> actions;
+		std::vector<Vec2Double> trajectories;
+	};
+
+	void carry_over(Game const& game, std::vector<Member> const& members);
+	void remember(double value, std::vector<Plan> const& plans);
+	Plan::Segment random_segment();
+	void mutate(std::vector<Member> const& members, std::vector<Plan> & plans);
+	// Safe to call from several threads with different scratch.
+	double score(WorldState const& start, std::vector<Member> const& members, std::vector<Plan> const& plans, Scratch & scratch) const;
+
+	TickContext* m_context;
+	ThreadPool* m_pool;
+	Simulator m_simulator;
+	std::vector<Control> m_controls;
+	// Per thread of the pool.
+	std::vector<Scratch> m_scratch;
+	// Prepared for the tick being planned.
+	BulletSimulator const* m_bullets;
+	// The best plans so far and the ones being climbed from.
+	std::vector<Plan> m_plans;
+	std::vector<Plan> m_current;
+	// Joint plans being scored at once, and their scores.
+	std::vector<std::vector<Plan>> m_batch;
+	std::vector<double> m_values;
+	std::mt19937 m_random;
+	int m_rollouts;
+	// The enemy each member aims at, by index in the units, or -1.
+	std::vector<int> m_targets;
+	// The best joint plans scored on m_elite_tick, best first, with the ids
+	// of the units they are for.
+	FixedVector<Scored, CARRIED> m_elite;
+	std::vector<int> m_elite_ids;
+	int m_elite_tick;
+	// Those of the last tick moved on to this one.
+	std::vector<std::vector<Plan>> m_carried;
+};
+
+#endif
@@ -0,0 +1,277 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <system_error>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+#ifdef __linux__
+	std::vector<int> allowed_cores()
+	{
+		std::vector<int> cores;
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) == 0)
+			for (auto core = 0; core < CPU_SETSIZE; ++core)
+				if (CPU_ISSET(core, &set))
+					cores.push_back(core);
+		return cores;
+	}
+
+	// Failing to pin only costs speed, so it is ignored.
+	void pin(unsigned thread)
+	{
+		auto const cores = allowed_cores();
+		if (cores.empty())
+			return;
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cores[thread % cores.size()], &set);
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	}
+#else
+	void pin(unsigned)
+	{
+	}
+#endif
+}
+
+unsigned ThreadPool::available_cores()
+{
+#ifdef __linux__
+	auto const cores = allowed_cores();
+	if (!cores.empty())
+		return static_cast<unsigned>(cores.size());
+#endif
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(unsigned threads)
+	: m_task(nullptr)
+	, m_remaining(0)
+	, m_generation(0)
+	, m_stop(false)
+{
+	threads = std::max(1u, threads);
+	for (auto i = 0u; i < threads; ++i)
+		m_ranges.push_back(std::make_unique<Range>());
+	if (threads == 1)
+		return;
+	// A host that won't give us more threads gets a smaller pool.
+	for (auto i = 1u; i < threads; ++i)
+	{
+		try
+		{
+			m_workers.emplace_back([this, i] () { loop(i); });
+		}
+		catch (std::system_error const&)
+		{
+			break;
+		}
+	}
+	m_ranges.resize(m_workers.size() + 1);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (auto & worker : m_workers)
+		worker.join();
+	if (m_background.joinable())
+		m_background.join();
+}
+
+void ThreadPool::run(size_t count, Task const& task)
+{
+	if (m_workers.empty() || count <= 1)
+	{
+		for (size_t i = 0; i < count; ++i)
+			task(i, 0);
+		return;
+	}
+	m_task = &task;
+	m_remaining.store(count);
+	auto const threads = m_ranges.size();
+	for (size_t i = 0; i < threads; ++i)
+	{
+		std::lock_guard<std::mutex> lock(m_ranges[i]->mutex);
+		m_ranges[i]->begin = count * i / threads;
+		m_ranges[i]->end = count * (i + 1) / threads;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_generation;
+	}
+	m_wake.notify_all();
+
+	work(0);
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this] () { return m_remaining.load() == 0; });
+	auto const error = m_error;
+	m_error = nullptr;
+	lock.unlock();
+	if (error)
+		std::rethrow_exception(error);
+}
+
+std::future<void> ThreadPool::post(Job job)
+{
+	auto const task = std::make_shared<std::packaged_task<void()>>(std::move(job));
+	auto result = task->get_future();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_workers.empty() && !m_background.joinable())
+	{
+		try
+		{
+			m_background = std::thread([this] () { serve(); });
+		}
+		catch (std::system_error const&)
+		{
+			lock.unlock();
+			(*task)();
+			return result;
+		}
+	}
+	m_jobs.push_back([task] () { (*task)(); });
+	lock.unlock();
+	m_wake.notify_one();
+	return result;
+}
+
+// Workers join a new batch before they take the next job.
+void ThreadPool::loop(unsigned thread)
+{
+	pin(thread);
+	auto seen = 0u;
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&] () { return m_stop || m_generation != seen || !m_jobs.empty(); });
+			if (m_stop)
+				return;
+			if (m_generation != seen)
+				seen = m_generation;
+			else
+			{
+				job = std::move(m_jobs.front());
+				m_jobs.pop_front();
+			}
+		}
+		if (job)
+			job();
+		else
+			work(thread);
+	}
+}
+
+void ThreadPool::serve()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this] () { return m_stop || !m_jobs.empty(); });
+			if (m_stop)
+				return;
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+		job();
+	}
+}
+
+void ThreadPool::work(unsigned thread)
+{
+	size_t index;
+	while (take(thread, index))
+	{
+		try
+		{
+			(*m_task)(index, thread);
+		}
+		catch (...)
+		{
+			fail(std::current_exception());
+		}
+		finish(1);
+	}
+}
+
+// Keeps the first exception and empties every range, so that the batch is
+// done as soon as the tasks already started are. Indices a thread is in the
+// middle of stealing are run as usual.
+void ThreadPool::fail(std::exception_ptr error)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_error)
+			m_error = error;
+	}
+	for (auto & range : m_ranges)
+	{
+		size_t dropped;
+		{
+			std::lock_guard<std::mutex> lock(range->mutex);
+			dropped = range->end - range->begin;
+			range->begin = range->end;
+		}
+		if (dropped > 0)
+			finish(dropped);
+	}
+}
+
+void ThreadPool::finish(size_t count)
+{
+	if (m_remaining.fetch_sub(count) == count)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_done.notify_all();
+	}
+}
+
+// The thread's own indices go front to back; once they run out it steals
+// the back half of the first other range that has any left.
+bool ThreadPool::take(unsigned thread, size_t & index)
+{
+	auto & own = *m_ranges[thread];
+	{
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (own.begin < own.end)
+		{
+			index = own.begin++;
+			return true;
+		}
+	}
+	for (size_t i = 1; i < m_ranges.size(); ++i)
+	{
+		auto & victim = *m_ranges[(thread + i) % m_ranges.size()];
+		size_t begin;
+		size_t end;
+		{
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (victim.begin >= victim.end)
+				continue;
+			end = victim.end;
+			begin = victim.begin + (victim.end - victim.begin) / 2;
+			victim.end = begin;
+		}
+		std::lock_guard<std::mutex> lock(own.mutex);
+		index = begin;
+		own.begin = begin + 1;
+		own.end = end;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,87 @@
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads for running many small independent tasks, created once for the
+// whole game. run() splits the indices of a batch evenly between the
+// threads, the caller included, and a thread that runs out takes half of
+// what is left to another. Each worker is pinned to one of the cores the
+// process may run on, the caller's thread is left alone; with a single
+// core, run() calls the tasks in order on the calling thread.
+//
+// Jobs posted for the background run on the workers between batches, or on
+// a thread of their own when the pool has no workers.
+class ThreadPool final
+{
+public:
+	using Task = std::function<void(size_t index, unsigned thread)>;
+	using Job = std::function<void()>;
+
+	// The cores the process is allowed to run on, at least one.
+	static unsigned available_cores();
+
+	explicit ThreadPool(unsigned threads = available_cores());
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool & operator = (ThreadPool const&) = delete;
+
+	// Threads, the caller included; `thread` passed to tasks is below this.
+	unsigned size() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+	// Calls task(index, thread) for every index below count and returns when
+	// all of them are done. The caller's thread is thread 0. Once a task
+	// throws, the indices no thread has started are skipped, and the first
+	// exception is rethrown here when the running tasks are done.
+	void run(size_t count, Task const& task);
+
+	// Queues a job for the background and returns; if no thread can be
+	// started for it, runs it first. Jobs still queued when the pool is
+	// destroyed are dropped, so they should own what they work on. What the
+	// job throws ends up in the returned future.
+	std::future<void> post(Job job);
+
+private:
+	// The indices [begin, end) a thread has yet to run.
+	struct Range
+	{
+		std::mutex mutex;
+		size_t begin = 0;
+		size_t end = 0;
+	};
+
+	void loop(unsigned thread);
+	void serve();
+	void work(unsigned thread);
+	bool take(unsigned thread, size_t & index);
+	void fail(std::exception_ptr error);
+	void finish(size_t count);
+
+	std::vector<std::unique_ptr<Range>> m_ranges;
+	std::vector<std::thread> m_workers;
+	Task const* m_task;
+	std::atomic<size_t> m_remaining;
+	// The first exception of the running batch.
+	std::exception_ptr m_error;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	unsigned m_generation;
+	bool m_stop;
+	std::deque<Job> m_jobs;
+	// Runs the jobs when there are no workers.
+	std::thread m_background;
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "TickContext.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+TickContext::TickContext(World const& world, Navigation const& navigation)
+	: m_navigation(&navigation)
+	, m_nav_graph(nullptr)
+	, m_travel_table(nullptr)
+	, m_line_of_fire(world.level)
+	, m_bullets(world.properties, world.level, DANGER_HORIZON)
+	, m_ticks_per_cell(world.properties.ticksPerSecond / world.properties.unitMaxHorizontalSpeed)
+	, m_game(nullptr)
+	, m_player_id(0)
+	, m_tick(-1)
+	, m_enemies_listed(false)
+	, m_bullets_prepared(false)
+{
+}
+
+void TickContext::reset(Game const& game, int player_id)
+{
+	m_game = &game;
+	m_player_id = player_id;
+	m_tick = game.currentTick;
+	m_nav_graph = m_navigation->graph();
+	m_travel_table = m_navigation->table();
+	m_enemies.clear();
+	m_enemies_listed = false;
+	m_searched.clear();
+	m_bullets_prepared = false;
+	m_nearest_enemy.assign(game.units.size(), std::nullopt);
+	m_nearest_health_pack.assign(game.units.size(), std::nullopt);
+	m_nearest_weapon.assign(game.units.size() * WEAPON_TYPE_COUNT, std::nullopt);
+}
+
+std::vector<Unit const*> const& TickContext::enemies()
+{
+	if (!m_enemies_listed)
+	{
+		for (auto const& u : m_game->units)
+			if (u.playerId != m_player_id)
+				m_enemies.push_back(&u);
+		m_enemies_listed = true;
+	}
+	return m_enemies;
+}
+
+double TickContext::travel_time(Vec2Double const& from, Vec2Double const& to)
+{
+	auto const source = m_nav_graph != nullptr ? m_nav_graph->locate(from) : -1;
+	auto const target = m_nav_graph != nullptr ? m_nav_graph->locate(to) : -1;
+	if (source < 0 || target < 0)
+		return (std::abs(from.x - to.x) + std::abs(from.y - to.y)) * m_ticks_per_cell;
+	if (m_travel_table != nullptr)
+	{
+		auto const ticks = m_travel_table->ticks(source, target);
+		return ticks == TravelTable::UNREACHABLE ? std::numeric_limits<double>::infinity() : static_cast<double>(ticks);
+	}
+	auto found = m_searched.find(source);
+	if (found == m_searched.end())
+		found = m_searched.emplace(source, m_nav_graph->paths_from(source)).first;
+	auto const ticks = found->second.ticks[target];
+	return ticks == NavGraph::UNREACHABLE ? std::numeric_limits<double>::infinity() : static_cast<double>(ticks);
+}
+
+Unit const* TickContext::nearest_enemy(Unit const& unit)
+{
+	auto & memo = m_nearest_enemy[index_of(unit)];
+	if (memo.has_value())
+		return *memo;
+	Unit const* result = nullptr;
+	std::pair<bool, double> min_rank;
+	for (auto const enemy : enemies())
+	{
+		auto const t = travel_time(unit.position, enemy->position);
+		std::pair<bool, double> const rank = { std::isinf(t), std::isinf(t) ? std::abs(unit.position.x - enemy->position.x) + std::abs(unit.position.y - enemy->position.y) : t };
+		if (result == nullptr || rank < min_rank)
+		{
+			min_rank = rank;
+			result = enemy;
+		}
+	}
+	memo = result;
+	return result;
+}
+
+LootBox const* TickContext::nearest_health_pack(Unit const& unit)
+{
+	auto & memo = m_nearest_health_pack[index_of(unit)];
+	if (memo.has_value())
+		return *memo;
+	auto const enemy = nearest_enemy(unit);
+	LootBox const* result = nullptr;
+	auto min_time = std::numeric_limits<double>::infinity();
+	for (auto const i : m_game->healthPackBoxes)
+	{
+		auto const& l = m_game->lootBoxes[i];
+		auto t = travel_time(unit.position, l.position);
+		if (enemy != nullptr && travel_time(enemy->position, l.position) < t)
+			t += 100.0 * m_ticks_per_cell;
+		if (t < min_time)
+		{
+			min_time = t;
+			result = &l;
+		}
+	}
+	memo = result;
+	return result;
+}
+
+LootBox const* TickContext::nearest_weapon(Unit const& unit, WeaponType type)
+{
+	auto & memo = m_nearest_weapon[index_of(unit) * WEAPON_TYPE_COUNT + type];
+	if (!memo.has_value())
+		memo = nearest_box(unit, m_game->weaponBoxes[type]);
+	return *memo;
+}
+
+LootBox const* TickContext::nearest_box(Unit const& unit, std::vector<int> const& boxes)
+{
+	LootBox const* result = nullptr;
+	auto min_time = std::numeric_limits<double>::infinity();
+	for (auto const i : boxes)
+	{
+		auto const& l = m_game->lootBoxes[i];
+		auto const t = travel_time(unit.position, l.position);
+		if (t < min_time)
+		{
+			min_time = t;
+			result = &l;
+		}
+	}
+	return result;
+}
+
+BulletSimulator const& TickContext::bullets()
+{
+	if (!m_bullets_prepared)
+	{
+		m_bullets.prepare(*m_game);
+		m_bullets_prepared = true;
+	}
+	return m_bullets;
+}
+
+int const* TickContext::danger(Unit const& unit)
+{
+	return bullets().timeline(index_of(unit));
+}
+
+size_t TickContext::index_of(Unit const& unit) const
+{
+	for (size_t i = 0; i < m_game->units.size(); ++i)
+		if (m_game->units[i].id == unit.id)
+			return i;
+	throw std::runtime_error("Unit " + std::to_string(unit.id) + " is not in the game");
+}
@@ -0,0 +1,95 @@
+#ifndef _TICK_CONTEXT_HPP_
+#define _TICK_CONTEXT_HPP_
+
+#include "BulletSimulator.hpp"
+#include "LineOfFire.hpp"
+#include "NavGraph.hpp"
+#include "Navigation.hpp"
+#include "TravelTable.hpp"
+#include "WorldState.hpp"
+#include "model/Game.hpp"
+
+#include <map>
+#include <optional>
+#include <vector>
+
+// What the strategy derives from a game snapshot, shared by all of our units
+// for one tick. Each fact is worked out the first time a unit asks for it
+// and remembered until reset() moves the context to the next tick; the
+// storage is kept across ticks.
+class TickContext final
+{
+public:
+	// Bullets are traced this many ticks ahead for danger().
+	static constexpr int DANGER_HORIZON = 60;
+
+	// The world and the navigation must outlive the context.
+	TickContext(World const& world, Navigation const& navigation);
+
+	// Starts a tick of the game as seen by the player. The game must stay
+	// unchanged until the next reset. The graph and the table are taken as
+	// far as they are built now, and stay so for the tick.
+	void reset(Game const& game, int player_id);
+
+	Game const& game() const { return *m_game; }
+	int tick() const { return m_tick; }
+	LineOfFire const& line_of_fire() const { return m_line_of_fire; }
+	// Null until the graph is built.
+	NavGraph const* nav_graph() const { return m_nav_graph; }
+
+	std::vector<Unit const*> const& enemies();
+
+	// Ticks for a unit at `from` to get to where something at `to` stands by
+	// the shortest route of the navigation graph, infinite if it can't. Off
+	// the graph, as over a pit, or before the graph is built, the Manhattan
+	// distance at full speed stands in.
+	double travel_time(Vec2Double const& from, Vec2Double const& to);
+	// Except while the graph is built and the table isn't, travel_time()
+	// only reads and may be called from several threads at once.
+	bool travel_time_concurrent() const { return m_nav_graph == nullptr || m_travel_table != nullptr; }
+
+	// The enemy the unit gets to soonest; enemies out of reach come after
+	// those in reach, nearest first. Null when there are none.
+	Unit const* nearest_enemy(Unit const& unit);
+	// The health pack the unit gets to soonest, counting those its nearest
+	// enemy gets to first as a hundred cells farther. Null when none is in
+	// reach.
+	LootBox const* nearest_health_pack(Unit const& unit);
+	// The box of the weapon type the unit gets to soonest, or null.
+	LootBox const* nearest_weapon(Unit const& unit, WeaponType type);
+
+	// The bullets in flight, traced DANGER_HORIZON ticks ahead against the
+	// units where they stand.
+	BulletSimulator const& bullets();
+	// Damage the unit takes in each of the next DANGER_HORIZON ticks from the
+	// bullets in flight if it keeps still.
+	int const* danger(Unit const& unit);
+
+private:
+	size_t index_of(Unit const& unit) const;
+	LootBox const* nearest_box(Unit const& unit, std::vector<int> const& boxes);
+
+	Navigation const* m_navigation;
+	NavGraph const* m_nav_graph;
+	TravelTable const* m_travel_table;
+	LineOfFire m_line_of_fire;
+	BulletSimulator m_bullets;
+	double m_ticks_per_cell;
+
+	Game const* m_game;
+	int m_player_id;
+	int m_tick;
+
+	std::vector<Unit const*> m_enemies;
+	bool m_enemies_listed;
+	// Until the travel table is ready, the graph is searched from each
+	// source the first time it is asked about.
+	std::map<int, NavGraph::Paths> m_searched;
+	bool m_bullets_prepared;
+	// By index in game.units; weapon boxes by index * WEAPON_TYPE_COUNT + type.
+	std::vector<std::optional<Unit const*>> m_nearest_enemy;
+	std::vector<std::optional<LootBox const*>> m_nearest_health_pack;
+	std::vector<std::optional<LootBox const*>> m_nearest_weapon;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "TravelTable.hpp"
+
+#include <algorithm>
+
+TravelTable::TravelTable(std::shared_ptr<NavGraph const> graph)
+	: m_graph(std::move(graph))
+	, m_count(m_graph->node_count())
+	, m_ticks(m_count * m_count, UNREACHABLE)
+	, m_remaining(m_count)
+{
+}
+
+std::shared_ptr<TravelTable const> TravelTable::build(std::shared_ptr<NavGraph const> graph, ThreadPool & pool)
+{
+	std::shared_ptr<TravelTable> table(new TravelTable(std::move(graph)));
+	for (size_t begin = 0; begin < table->m_count; begin += ROWS_PER_JOB)
+	{
+		auto const end = std::min(begin + ROWS_PER_JOB, table->m_count);
+		pool.post([table, begin, end] () { table->fill(begin, end); });
+	}
+	return table;
+}
+
+// Each row is written by a single job, and the release of the last row
+// publishes the whole table to ready().
+void TravelTable::fill(size_t begin, size_t end)
+{
+	for (auto from = begin; from < end; ++from)
+	{
+		auto const paths = m_graph->paths_from(static_cast<int>(from));
+		auto row = m_ticks.begin() + from * m_count;
+		for (auto const ticks : paths.ticks)
+		{
+			if (ticks != NavGraph::UNREACHABLE)
+				*row = static_cast<uint16_t>(std::min(ticks, UNREACHABLE - 1));
+			++row;
+		}
+		m_remaining.fetch_sub(1, std::memory_order_release);
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef _TRAVEL_TABLE_HPP_
+#define _TRAVEL_TABLE_HPP_
+
+#include "NavGraph.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Shortest travel times between all pairs of NavGraph nodes, in ticks. The
+// table is filled by background jobs on the pool, one Dijkstra run per
+// source node, so the strategy keeps answering ticks while it is built;
+// until ready() the caller searches the graph itself.
+class TravelTable final
+{
+public:
+	static constexpr uint16_t UNREACHABLE = UINT16_MAX;
+	// Source nodes per job.
+	static constexpr size_t ROWS_PER_JOB = 16;
+
+	// Starts filling the table on the pool. The jobs share the table and the
+	// graph, so either may be dropped before they are done.
+	static std::shared_ptr<TravelTable const> build(std::shared_ptr<NavGraph const> graph, ThreadPool & pool);
+
+	TravelTable(TravelTable const&) = delete;
+	TravelTable & operator = (TravelTable const&) = delete;
+
+	bool ready() const { return m_remaining.load(std::memory_order_acquire) == 0; }
+
+	// Only valid once ready(). Times longer than the table holds are stored
+	// as UNREACHABLE - 1.
+	uint16_t ticks(int from, int to) const { return m_ticks[from * m_count + to]; }
+
+private:
+	explicit TravelTable(std::shared_ptr<NavGraph const> graph);
+
+	void fill(size_t begin, size_t end);
+
+	std::shared_ptr<NavGraph const> m_graph;
+	size_t m_count;
+	std::vector<uint16_t> m_ticks;
+	std::atomic<size_t> m_remaining;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "WorldState.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	double distance_to(Vec2Double const& point, Unit const& unit)
+	{
+		return std::hypot(point.x - unit.position.x, point.y - (unit.position.y + unit.size.y / 2.0));
+	}
+
+	UnitState state_of(Unit const& unit)
+	{
+		UnitState state { unit.playerId, unit.id, unit.health, unit.position, unit.size, unit.jumpState,
+			unit.walkedRight, unit.stand, unit.onGround, unit.onLadder, unit.mines, std::nullopt };
+		if (unit.weapon)
+		{
+			auto const& weapon = *unit.weapon;
+			state.weapon = WeaponState { weapon.typ, weapon.magazine, weapon.wasShooting, weapon.spread,
+				weapon.fireTimer, weapon.lastAngle, weapon.lastFireTick };
+		}
+		return state;
+	}
+
+	BulletState state_of(Bullet const& bullet)
+	{
+		return { bullet.weaponType, bullet.unitId, bullet.playerId, bullet.position, bullet.velocity };
+	}
+
+	PlantedMine state_of(Mine const& mine)
+	{
+		return { mine.playerId, mine.position, mine.state, mine.timer };
+	}
+
+	// Fills `target` with the states of the items of lowest `rank`, in the
+	// order of `source` as long as they all fit.
+	template <typename T, size_t N, typename Item, typename Rank>
+	void fill_lowest(FixedVector<T, N> & target, std::vector<Item> const& source, Rank const& rank)
+	{
+		target.clear();
+		if (source.size() <= N)
+		{
+			for (auto const& item : source)
+				target.push_back(state_of(item));
+			return;
+		}
+		std::array<double, N> ranks;
+		for (auto const& item : source)
+		{
+			auto const value = rank(item);
+			if (!target.full())
+			{
+				ranks[target.size()] = value;
+				target.push_back(state_of(item));
+				continue;
+			}
+			auto const worst = std::max_element(ranks.begin(), ranks.end()) - ranks.begin();
+			if (value < ranks[worst])
+			{
+				ranks[worst] = value;
+				target[worst] = state_of(item);
+			}
+		}
+	}
+}
+
+std::shared_ptr<World const> World::of(Game const& game)
+{
+	return std::make_shared<World const>(World { game.properties, game.level });
+}
+
+bool WorldState::fits(Game const& game)
+{
+	return game.players.size() <= MAX_PLAYERS && game.units.size() <= MAX_UNITS;
+}
+
+WorldState::WorldState(Game const& game)
+	: currentTick(game.currentTick)
+{
+	for (auto const& player : game.players)
+		players.push_back(player);
+	for (auto const& unit : game.units)
+		units.push_back(state_of(unit));
+	fill_lowest(bullets, game.bullets, [&] (Bullet const& bullet) {
+		auto closest = std::numeric_limits<double>::infinity();
+		for (auto const& unit : game.units)
+			if (unit.id != bullet.unitId)
+				closest = std::min(closest, distance_to(bullet.position, unit));
+		return closest / std::max(std::hypot(bullet.velocity.x, bullet.velocity.y), 1e-9);
+	});
+	fill_lowest(mines, game.mines, [&] (Mine const& mine) {
+		auto closest = std::numeric_limits<double>::infinity();
+		for (auto const& unit : game.units)
+			closest = std::min(closest, distance_to(mine.position, unit));
+		return closest;
+	});
+}
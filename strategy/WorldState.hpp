@@ -0,0 +1,101 @@
+#ifndef _WORLD_STATE_HPP_
+#define _WORLD_STATE_HPP_
+
+#include "FixedVector.hpp"
+#include "model/Game.hpp"
+
+#include <memory>
+
+// The parts of a game that stay the same for the whole match, weapon
+// parameters included. Search states share one instance through a single
+// shared pointer.
+struct World
+{
+	Properties properties;
+	Level level;
+
+	static std::shared_ptr<World const> of(Game const& game);
+};
+
+// What changes of a unit's weapon; its parameters are those of its type in
+// World::properties.weaponParams.
+struct WeaponState
+{
+	WeaponType typ;
+	int magazine;
+	bool wasShooting;
+	double spread;
+	std::optional<double> fireTimer;
+	std::optional<double> lastAngle;
+	std::optional<int> lastFireTick;
+};
+
+// A Unit without the weapon parameters, with its fields named after Unit's
+// so that the Simulator moves either.
+struct UnitState
+{
+	int playerId;
+	int id;
+	int health;
+	Vec2Double position;
+	Vec2Double size;
+	JumpState jumpState;
+	bool walkedRight;
+	bool stand;
+	bool onGround;
+	bool onLadder;
+	int mines;
+	std::optional<WeaponState> weapon;
+};
+
+// A Bullet without what its weapon type decides: the damage, size and
+// explosion are those of World::properties.weaponParams[weaponType].
+struct BulletState
+{
+	WeaponType weaponType;
+	int unitId;
+	int playerId;
+	Vec2Double position;
+	Vec2Double velocity;
+};
+
+// A Mine without what every mine shares: the size, trigger radius and
+// explosion are those in World::properties.
+struct PlantedMine
+{
+	int playerId;
+	Vec2Double position;
+	MineState state;
+	std::optional<double> timer;
+};
+
+// The parts of a game that change from tick to tick, in fixed-size storage
+// and without pointers to the heap: saving or restoring a state, or
+// branching off a copy of it, copies the units, bullets and mines in play
+// and nothing else. The fields are named after Game's, so the Simulator
+// advances either.
+class WorldState final
+{
+public:
+	static constexpr size_t MAX_PLAYERS = 4;
+	static constexpr size_t MAX_UNITS = 4;
+	static constexpr size_t MAX_BULLETS = 32;
+	static constexpr size_t MAX_MINES = 8;
+
+	// Whether the players and units of `game` fit; bullets and mines always
+	// do.
+	static bool fits(Game const& game);
+
+	// Requires fits(game). Beyond capacity, the bullets that would take the
+	// longest to reach a unit they can hit and the mines furthest from every
+	// unit are left out.
+	explicit WorldState(Game const& game);
+
+	int currentTick;
+	FixedVector<Player, MAX_PLAYERS> players;
+	FixedVector<UnitState, MAX_UNITS> units;
+	FixedVector<BulletState, MAX_BULLETS> bullets;
+	FixedVector<PlantedMine, MAX_MINES> mines;
+};
+
+#endif
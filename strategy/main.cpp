@@ -1,39 +1,75 @@
+#include "AllocationCounter.hpp"
 #include "Debug.hpp"
 #include "MyStrategy.hpp"
+#include "ServerMessageDecoder.hpp"
 #include "TcpStream.hpp"
+#include "ThreadPool.hpp"
 #include "model/PlayerMessageGame.hpp"
 #include "model/ServerMessageGame.hpp"
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class Runner {
 public:
-  Runner(const std::string &host, int port, const std::string &token) {
-    std::shared_ptr<TcpStream> tcpStream(new TcpStream(host, port));
+  Runner(std::shared_ptr<TcpStream> tcpStream, const std::string &token,
+         double planBudgetMs)
+      : planBudgetMs(planBudgetMs) {
     inputStream = getInputStream(tcpStream);
     outputStream = getOutputStream(tcpStream);
     outputStream->write(token);
     outputStream->flush();
   }
   void run() {
-    MyStrategy myStrategy;
+    MyStrategy myStrategy(threadPool, planBudgetMs);
     Debug debug(outputStream);
+    // The message is decoded in place every tick, so the game snapshot keeps
+    // its vectors' capacity and heap payloads between ticks.
+    ServerMessageGame message;
+    // Elements are decoded as soon as their bytes arrive, overlapping the
+    // parse with the rest of the snapshot still in flight.
+    ServerMessageDecoder decoder;
     while (true) {
-      auto message = ServerMessageGame::readFrom(*inputStream);
+#ifdef COUNT_ALLOCATIONS
+      size_t allocationsBefore = AllocationCounter::count();
+#endif
+      decoder.start(message);
+      while (decoder.decode() == ServerMessageDecoder::NEED_MORE) {
+        char *buffer = decoder.receiveBuffer();
+        decoder.commit(
+            inputStream->readSome(buffer, decoder.receiveCapacity()));
+      }
       const auto& playerView = message.playerView;
       if (!playerView) {
         break;
       }
-      std::unordered_map<int, UnitAction> actions;
+#ifdef COUNT_ALLOCATIONS
+      size_t decodeAllocations = AllocationCounter::count() - allocationsBefore;
+#endif
+      if (actions.capacity() == 0) {
+        actions.reserve(playerView->game.properties.teamSize);
+      }
+      actions.clear();
+      // The team is planned once per tick; getAction hands out the parts.
+      myStrategy.planTeam(playerView->game, playerView->myId, debug);
       for (const Unit &unit : playerView->game.units) {
         if (unit.playerId == playerView->myId) {
-          actions.emplace(std::make_pair(
-              unit.id,
-              myStrategy.getAction(unit, playerView->game, debug)));
+          actions.emplace_back(
+              unit.id, myStrategy.getAction(unit, playerView->game, debug));
         }
       }
-      PlayerMessageGame::ActionMessage(Versioned(actions)).writeTo(*outputStream);
+#ifdef COUNT_ALLOCATIONS
+      // Read before the report is built, which allocates itself.
+      size_t tickAllocations = AllocationCounter::count() - allocationsBefore;
+      debug.draw(CustomData::Log("Allocations: decode " +
+                                 std::to_string(decodeAllocations) + ", tick " +
+                                 std::to_string(tickAllocations)));
+#endif
+      // Queued debug commands go out in the same write as the actions.
+      debug.flush();
+      PlayerMessageGame::ActionMessage::writeTo(*outputStream, actions.data(),
+                                                actions.size());
       outputStream->flush();
     }
   }
@@ -41,12 +77,44 @@ public:
 private:
   std::shared_ptr<InputStream> inputStream;
   std::shared_ptr<OutputStream> outputStream;
+  double planBudgetMs;
+  // One thread per core we may use, started once for the whole game.
+  ThreadPool threadPool;
+  // Reserved once for the team size, so the reply path never allocates.
+  std::vector<std::pair<int, UnitAction>> actions;
 };
 
+// The host argument picks the backend: "unix:PATH" connects to a Unix-domain
+// socket and "pipe" talks over stdin/stdout; anything else is a TCP host.
+static std::shared_ptr<TcpStream> openStream(const std::string &host, int port,
+                                             const TcpStream::Options &options) {
+#ifndef _WIN32
+  const std::string unixPrefix = "unix:";
+  if (host.compare(0, unixPrefix.size(), unixPrefix) == 0) {
+    return TcpStream::connectUnix(host.substr(unixPrefix.size()), options);
+  }
+  if (host == "pipe") {
+    return TcpStream::fromPipes(STDIN_FILENO, STDOUT_FILENO, options);
+  }
+#endif
+  return std::shared_ptr<TcpStream>(new TcpStream(host, port, options));
+}
+
 int main(int argc, char *argv[]) {
   std::string host = argc < 2 ? "127.0.0.1" : argv[1];
   int port = argc < 3 ? 31001 : atoi(argv[2]);
   std::string token = argc < 4 ? "0000000000000000" : argv[3];
-  Runner(host, port, token).run();
+  TcpStream::Options options;
+  if (argc >= 5) {
+    options.receiveBufferSize = atoi(argv[4]);
+  }
+  if (argc >= 6) {
+    options.sendBufferSize = atoi(argv[5]);
+  }
+  // Milliseconds of planning per tick; less trades strength for CPU on
+  // shared hosts.
+  double planBudgetMs =
+      argc < 7 ? MyStrategy::DEFAULT_PLAN_BUDGET_MS : atof(argv[6]);
+  Runner(openStream(host, port, options), token, planBudgetMs).run();
   return 0;
-}
\ No newline at end of file
+}
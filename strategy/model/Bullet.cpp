@@ -1,9 +1,13 @@
 #include "Bullet.hpp"
 
 Bullet::Bullet() { }
-Bullet::Bullet(WeaponType weaponType, int unitId, int playerId, Vec2Double position, Vec2Double velocity, int damage, double size, std::shared_ptr<ExplosionParams> explosionParams) : weaponType(weaponType), unitId(unitId), playerId(playerId), position(position), velocity(velocity), damage(damage), size(size), explosionParams(explosionParams) { }
+Bullet::Bullet(WeaponType weaponType, int unitId, int playerId, Vec2Double position, Vec2Double velocity, int damage, double size, std::optional<ExplosionParams> explosionParams) : weaponType(weaponType), unitId(unitId), playerId(playerId), position(position), velocity(velocity), damage(damage), size(size), explosionParams(explosionParams) { }
 Bullet Bullet::readFrom(InputStream& stream) {
     Bullet result;
+    readFrom(stream, result);
+    return result;
+}
+void Bullet::readFrom(InputStream& stream, Bullet& result) {
     switch (stream.readInt()) {
     case 0:
         result.weaponType = WeaponType::PISTOL;
@@ -24,12 +28,10 @@ Bullet Bullet::readFrom(InputStream& stream) {
     result.damage = stream.readInt();
     result.size = stream.readDouble();
     if (stream.readBool()) {
-        result.explosionParams = std::shared_ptr<ExplosionParams>(new ExplosionParams());
-        *result.explosionParams = ExplosionParams::readFrom(stream);
+        result.explosionParams = ExplosionParams::readFrom(stream);
     } else {
-        result.explosionParams = std::shared_ptr<ExplosionParams>();
+        result.explosionParams.reset();
     }
-    return result;
 }
 void Bullet::writeTo(OutputStream& stream) const {
     stream.write((int)(weaponType));
@@ -40,10 +42,10 @@ void Bullet::writeTo(OutputStream& stream) const {
     stream.write(damage);
     stream.write(size);
     if (explosionParams) {
-        stream.write(false);
-    } else {
         stream.write(true);
         (*explosionParams).writeTo(stream);
+    } else {
+        stream.write(false);
     }
 }
 std::string Bullet::toString() const {
@@ -9,7 +9,7 @@
 #include "Vec2Double.hpp"
 #include <stdexcept>
 #include "Vec2Double.hpp"
-#include <memory>
+#include <optional>
 #include <stdexcept>
 #include "ExplosionParams.hpp"
 
@@ -22,10 +22,11 @@ public:
     Vec2Double velocity;
     int damage;
     double size;
-    std::shared_ptr<ExplosionParams> explosionParams;
+    std::optional<ExplosionParams> explosionParams;
     Bullet();
-    Bullet(WeaponType weaponType, int unitId, int playerId, Vec2Double position, Vec2Double velocity, int damage, double size, std::shared_ptr<ExplosionParams> explosionParams);
+    Bullet(WeaponType weaponType, int unitId, int playerId, Vec2Double position, Vec2Double velocity, int damage, double size, std::optional<ExplosionParams> explosionParams);
     static Bullet readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, Bullet& result);
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
@@ -1,33 +1,56 @@
 #include "Game.hpp"
 
 Game::Game() { }
-Game::Game(int currentTick, Properties properties, Level level, std::vector<Player> players, std::vector<Unit> units, std::vector<Bullet> bullets, std::vector<Mine> mines, std::vector<LootBox> lootBoxes) : currentTick(currentTick), properties(properties), level(level), players(players), units(units), bullets(bullets), mines(mines), lootBoxes(lootBoxes) { }
+Game::Game(int currentTick, Properties properties, Level level, std::vector<Player> players, std::vector<Unit> units, std::vector<Bullet> bullets, std::vector<Mine> mines, std::vector<LootBox> lootBoxes) : currentTick(currentTick), properties(properties), level(level), players(players), units(units), bullets(bullets), mines(mines), lootBoxes(lootBoxes) {
+    indexLootBoxes();
+}
 Game Game::readFrom(InputStream& stream) {
     Game result;
+    readFrom(stream, result);
+    return result;
+}
+void Game::readFrom(InputStream& stream, Game& result) {
     result.currentTick = stream.readInt();
-    result.properties = Properties::readFrom(stream);
-    result.level = Level::readFrom(stream);
-    result.players = std::vector<Player>(stream.readInt());
+    Properties::readFrom(stream, result.properties);
+    Level::readFrom(stream, result.level);
+    result.players.resize(stream.readInt());
     for (size_t i = 0; i < result.players.size(); i++) {
         result.players[i] = Player::readFrom(stream);
     }
-    result.units = std::vector<Unit>(stream.readInt());
+    result.units.resize(stream.readInt());
     for (size_t i = 0; i < result.units.size(); i++) {
-        result.units[i] = Unit::readFrom(stream);
+        Unit::readFrom(stream, result.units[i]);
     }
-    result.bullets = std::vector<Bullet>(stream.readInt());
+    result.bullets.resize(stream.readInt());
     for (size_t i = 0; i < result.bullets.size(); i++) {
-        result.bullets[i] = Bullet::readFrom(stream);
+        Bullet::readFrom(stream, result.bullets[i]);
     }
-    result.mines = std::vector<Mine>(stream.readInt());
+    result.mines.resize(stream.readInt());
     for (size_t i = 0; i < result.mines.size(); i++) {
-        result.mines[i] = Mine::readFrom(stream);
+        Mine::readFrom(stream, result.mines[i]);
     }
-    result.lootBoxes = std::vector<LootBox>(stream.readInt());
+    result.lootBoxes.resize(stream.readInt());
     for (size_t i = 0; i < result.lootBoxes.size(); i++) {
-        result.lootBoxes[i] = LootBox::readFrom(stream);
+        LootBox::readFrom(stream, result.lootBoxes[i]);
+    }
+    result.indexLootBoxes();
+}
+void Game::indexLootBoxes() {
+    healthPackBoxes.clear();
+    for (std::vector<int>& boxes : weaponBoxes) {
+        boxes.clear();
+    }
+    mineBoxes.clear();
+    for (size_t i = 0; i < lootBoxes.size(); i++) {
+        const Item& item = lootBoxes[i].item;
+        if (item.getHealthPack()) {
+            healthPackBoxes.push_back(static_cast<int>(i));
+        } else if (const Item::Weapon* weapon = item.getWeapon()) {
+            weaponBoxes[weapon->weaponType].push_back(static_cast<int>(i));
+        } else {
+            mineBoxes.push_back(static_cast<int>(i));
+        }
     }
-    return result;
 }
 void Game::writeTo(OutputStream& stream) const {
     stream.write(currentTick);
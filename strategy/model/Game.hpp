@@ -91,6 +91,7 @@
 #include "Item.hpp"
 #include <stdexcept>
 #include "WeaponType.hpp"
+#include <array>
 
 class Game {
 public:
@@ -102,9 +103,15 @@ public:
     std::vector<Bullet> bullets;
     std::vector<Mine> mines;
     std::vector<LootBox> lootBoxes;
+    // Indices into lootBoxes grouped by item type, rebuilt on every decode.
+    std::vector<int> healthPackBoxes;
+    std::array<std::vector<int>, WEAPON_TYPE_COUNT> weaponBoxes;
+    std::vector<int> mineBoxes;
     Game();
     Game(int currentTick, Properties properties, Level level, std::vector<Player> players, std::vector<Unit> units, std::vector<Bullet> bullets, std::vector<Mine> mines, std::vector<LootBox> lootBoxes);
     static Game readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, Game& result);
+    void indexLootBoxes();
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
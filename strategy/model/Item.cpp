@@ -48,7 +48,7 @@ std::string Item::Weapon::toString() const {
 }
 
 Item::Mine::Mine() { }
-Item::Mine Item::Mine::readFrom(InputStream& stream) {
+Item::Mine Item::Mine::readFrom(InputStream& /* stream */) {
     Item::Mine result;
     return result;
 }
@@ -59,15 +59,33 @@ std::string Item::Mine::toString() const {
     return std::string("Item::Mine") + "(" +
         ")";
 }
-std::shared_ptr<Item> Item::readFrom(InputStream& stream) {
+Item::Item() { }
+Item::Item(Item::HealthPack healthPack) : value(healthPack) { }
+Item::Item(Item::Weapon weapon) : value(weapon) { }
+Item::Item(Item::Mine mine) : value(mine) { }
+Item Item::readFrom(InputStream& stream) {
+    Item result;
+    readFrom(stream, result);
+    return result;
+}
+void Item::readFrom(InputStream& stream, Item& result) {
     switch (stream.readInt()) {
     case 0:
-        return std::shared_ptr<Item::HealthPack>(new Item::HealthPack(Item::HealthPack::readFrom(stream)));
+        result.value.emplace<Item::HealthPack>(Item::HealthPack::readFrom(stream));
+        break;
     case 1:
-        return std::shared_ptr<Item::Weapon>(new Item::Weapon(Item::Weapon::readFrom(stream)));
+        result.value.emplace<Item::Weapon>(Item::Weapon::readFrom(stream));
+        break;
     case 2:
-        return std::shared_ptr<Item::Mine>(new Item::Mine(Item::Mine::readFrom(stream)));
+        result.value.emplace<Item::Mine>(Item::Mine::readFrom(stream));
+        break;
     default:
         throw std::runtime_error("Unexpected discriminant value");
     }
-};
+}
+void Item::writeTo(OutputStream& stream) const {
+    std::visit([&](const auto& item) { item.writeTo(stream); }, value);
+}
+std::string Item::toString() const {
+    return std::visit([](const auto& item) { return item.toString(); }, value);
+}
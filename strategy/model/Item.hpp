@@ -2,55 +2,62 @@
 #define _MODEL_ITEM_HPP_
 
 #include "../Stream.hpp"
-#include <memory>
 #include <string>
+#include <variant>
 #include <stdexcept>
 #include <stdexcept>
 #include "WeaponType.hpp"
 
 class Item {
 public:
-    class HealthPack;
-    class Weapon;
-    class Mine;
+    class HealthPack {
+    public:
+        static const int TAG = 0;
+    public:
+        int health;
+        HealthPack();
+        HealthPack(int health);
+        static HealthPack readFrom(InputStream& stream);
+        void writeTo(OutputStream& stream) const;
+        std::string toString() const;
+    };
 
-    static std::shared_ptr<Item> readFrom(InputStream& stream);
-    virtual void writeTo(OutputStream& stream) const = 0;
-    virtual std::string toString() const = 0;
-};
-
-class Item::HealthPack : public Item {
-public:
-    static const int TAG = 0;
-public:
-    int health;
-    HealthPack();
-    HealthPack(int health);
-    static HealthPack readFrom(InputStream& stream);
-    void writeTo(OutputStream& stream) const;
-    std::string toString() const override;
-};
+    class Weapon {
+    public:
+        static const int TAG = 1;
+    public:
+        WeaponType weaponType;
+        Weapon();
+        Weapon(WeaponType weaponType);
+        static Weapon readFrom(InputStream& stream);
+        void writeTo(OutputStream& stream) const;
+        std::string toString() const;
+    };
 
-class Item::Weapon : public Item {
-public:
-    static const int TAG = 1;
-public:
-    WeaponType weaponType;
-    Weapon();
-    Weapon(WeaponType weaponType);
-    static Weapon readFrom(InputStream& stream);
-    void writeTo(OutputStream& stream) const;
-    std::string toString() const override;
-};
+    class Mine {
+    public:
+        static const int TAG = 2;
+    public:
+        Mine();
+        static Mine readFrom(InputStream& stream);
+        void writeTo(OutputStream& stream) const;
+        std::string toString() const;
+    };
 
-class Item::Mine : public Item {
-public:
-    static const int TAG = 2;
-public:
-    Mine();
-    static Mine readFrom(InputStream& stream);
+    // Alternatives are ordered by TAG, so value.index() is the tag.
+    std::variant<HealthPack, Weapon, Mine> value;
+    Item();
+    Item(HealthPack healthPack);
+    Item(Weapon weapon);
+    Item(Mine mine);
+    int getTag() const { return static_cast<int>(value.index()); }
+    const HealthPack* getHealthPack() const { return std::get_if<HealthPack>(&value); }
+    const Weapon* getWeapon() const { return std::get_if<Weapon>(&value); }
+    const Mine* getMine() const { return std::get_if<Mine>(&value); }
+    static Item readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, Item& result);
     void writeTo(OutputStream& stream) const;
-    std::string toString() const override;
+    std::string toString() const;
 };
 
 #endif
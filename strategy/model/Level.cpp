@@ -1,42 +1,98 @@
 #include "Level.hpp"
+#include <algorithm>
 
-Level::Level() { }
-Level::Level(std::vector<std::vector<Tile>> tiles) : tiles(tiles) { }
+Level::Level() : width(0), height(0) { }
+Level::Level(std::vector<std::vector<Tile>> tiles) : width(static_cast<int>(tiles.size())), height(tiles.empty() ? 0 : static_cast<int>(tiles[0].size())) {
+    this->tiles.resize(static_cast<size_t>(width) * height);
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            this->tiles[x * height + y] = static_cast<uint8_t>(tiles[x][y]);
+        }
+    }
+    buildLayers();
+}
+void Level::buildLayers() {
+    layers.assign(tiles.size(), 0);
+    for (size_t i = 0; i < tiles.size(); i++) {
+        switch (tiles[i]) {
+        case Tile::WALL:
+            layers[i] = SOLID_LAYER | STANDABLE_LAYER;
+            break;
+        case Tile::PLATFORM:
+            layers[i] = STANDABLE_LAYER;
+            break;
+        case Tile::LADDER:
+            layers[i] = STANDABLE_LAYER | LADDER_LAYER;
+            break;
+        case Tile::JUMP_PAD:
+            layers[i] = JUMP_PAD_LAYER;
+            break;
+        default:
+            break;
+        }
+    }
+}
 Level Level::readFrom(InputStream& stream) {
     Level result;
-    result.tiles = std::vector<std::vector<Tile>>(stream.readInt());
-    for (size_t i = 0; i < result.tiles.size(); i++) {
-        result.tiles[i] = std::vector<Tile>(stream.readInt());
-        for (size_t j = 0; j < result.tiles[i].size(); j++) {
-            switch (stream.readInt()) {
-            case 0:
-                result.tiles[i][j] = Tile::EMPTY;
-                break;
-            case 1:
-                result.tiles[i][j] = Tile::WALL;
-                break;
-            case 2:
-                result.tiles[i][j] = Tile::PLATFORM;
-                break;
-            case 3:
-                result.tiles[i][j] = Tile::LADDER;
-                break;
-            case 4:
-                result.tiles[i][j] = Tile::JUMP_PAD;
-                break;
-            default:
-                throw std::runtime_error("Unexpected discriminant value");
+    readFrom(stream, result);
+    return result;
+}
+void Level::readFrom(InputStream& stream, Level& result) {
+    // The tile map never changes during a game, so once it is cached the
+    // encoded tiles are only compared with the grid. They are validated and
+    // converted from the first one that differs, and only then are the
+    // layers rebuilt.
+    static const size_t CHUNK_TILES = 64;
+    int chunk[CHUNK_TILES];
+    int width = stream.readInt();
+    int height = 0;
+    bool changed = result.layers.empty() || width != result.width;
+    for (int x = 0; x < width; x++) {
+        int columnHeight = stream.readInt();
+        if (x == 0) {
+            height = columnHeight;
+            if (height != result.height) {
+                changed = true;
+            }
+            result.tiles.resize(static_cast<size_t>(width) * height);
+        } else if (columnHeight != height) {
+            throw std::runtime_error("Unexpected level column height");
+        }
+        uint8_t* column = result.tiles.data() + static_cast<size_t>(x) * height;
+        for (int y = 0; y < height; y += CHUNK_TILES) {
+            size_t chunkTiles = std::min(CHUNK_TILES, static_cast<size_t>(height - y));
+            stream.readArray(chunk, chunkTiles);
+            if (!changed) {
+                size_t i = 0;
+                while (i < chunkTiles && chunk[i] == column[y + i]) {
+                    i++;
+                }
+                if (i == chunkTiles) {
+                    continue;
+                }
+                changed = true;
+            }
+            for (size_t i = 0; i < chunkTiles; i++) {
+                if (chunk[i] < Tile::EMPTY || chunk[i] > Tile::JUMP_PAD) {
+                    throw std::runtime_error("Unexpected discriminant value");
+                }
+                column[y + i] = static_cast<uint8_t>(chunk[i]);
             }
         }
     }
-    return result;
+    if (!changed) {
+        return;
+    }
+    result.width = width;
+    result.height = height;
+    result.buildLayers();
 }
 void Level::writeTo(OutputStream& stream) const {
-    stream.write((int)(tiles.size()));
-    for (const std::vector<Tile>& tilesElement : tiles) {
-        stream.write((int)(tilesElement.size()));
-        for (const Tile& tilesElementElement : tilesElement) {
-            stream.write((int)(tilesElementElement));
+    stream.write(width);
+    for (int x = 0; x < width; x++) {
+        stream.write(height);
+        for (int y = 0; y < height; y++) {
+            stream.write(static_cast<int>(getTile(x, y)));
         }
     }
 }
@@ -2,6 +2,7 @@
 #define _MODEL_LEVEL_HPP_
 
 #include "../Stream.hpp"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <vector>
@@ -10,10 +11,31 @@
 
 class Level {
 public:
-    std::vector<std::vector<Tile>> tiles;
+    // Flags of the derived per-tile layers, built once when the level is decoded.
+    enum Layer : uint8_t {
+        SOLID_LAYER = 1,
+        STANDABLE_LAYER = 2,
+        LADDER_LAYER = 4,
+        JUMP_PAD_LAYER = 8
+    };
+
+    int width;
+    int height;
+    // Column-major tile grid: tile (x, y) is stored at x * height + y.
+    std::vector<uint8_t> tiles;
+    std::vector<uint8_t> layers;
     Level();
     Level(std::vector<std::vector<Tile>> tiles);
+    Tile getTile(int x, int y) const { return static_cast<Tile>(tiles[x * height + y]); }
+    uint8_t getLayers(int x, int y) const { return layers[x * height + y]; }
+    bool isInside(int x, int y) const { return 0 <= x && x < width && 0 <= y && y < height; }
+    bool isSolid(int x, int y) const { return (getLayers(x, y) & SOLID_LAYER) != 0; }
+    bool isStandable(int x, int y) const { return (getLayers(x, y) & STANDABLE_LAYER) != 0; }
+    bool isLadder(int x, int y) const { return (getLayers(x, y) & LADDER_LAYER) != 0; }
+    bool isJumpPad(int x, int y) const { return (getLayers(x, y) & JUMP_PAD_LAYER) != 0; }
+    void buildLayers();
     static Level readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, Level& result);
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
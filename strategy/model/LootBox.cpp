@@ -1,23 +1,26 @@
 #include "LootBox.hpp"
 
 LootBox::LootBox() { }
-LootBox::LootBox(Vec2Double position, Vec2Double size, std::shared_ptr<Item> item) : position(position), size(size), item(item) { }
+LootBox::LootBox(Vec2Double position, Vec2Double size, Item item) : position(position), size(size), item(item) { }
 LootBox LootBox::readFrom(InputStream& stream) {
     LootBox result;
+    readFrom(stream, result);
+    return result;
+}
+void LootBox::readFrom(InputStream& stream, LootBox& result) {
     result.position = Vec2Double::readFrom(stream);
     result.size = Vec2Double::readFrom(stream);
-    result.item = Item::readFrom(stream);
-    return result;
+    Item::readFrom(stream, result.item);
 }
 void LootBox::writeTo(OutputStream& stream) const {
     position.writeTo(stream);
     size.writeTo(stream);
-    item->writeTo(stream);
+    item.writeTo(stream);
 }
 std::string LootBox::toString() const {
     return std::string("LootBox") + "(" +
         position.toString() +
         size.toString() +
-        item->toString() +
+        item.toString() +
         ")";
 }
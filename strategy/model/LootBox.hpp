@@ -16,10 +16,11 @@ class LootBox {
 public:
     Vec2Double position;
     Vec2Double size;
-    std::shared_ptr<Item> item;
+    Item item;
     LootBox();
-    LootBox(Vec2Double position, Vec2Double size, std::shared_ptr<Item> item);
+    LootBox(Vec2Double position, Vec2Double size, Item item);
     static LootBox readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, LootBox& result);
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
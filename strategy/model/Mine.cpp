@@ -1,9 +1,13 @@
 #include "Mine.hpp"
 
 Mine::Mine() { }
-Mine::Mine(int playerId, Vec2Double position, Vec2Double size, MineState state, std::shared_ptr<double> timer, double triggerRadius, ExplosionParams explosionParams) : playerId(playerId), position(position), size(size), state(state), timer(timer), triggerRadius(triggerRadius), explosionParams(explosionParams) { }
+Mine::Mine(int playerId, Vec2Double position, Vec2Double size, MineState state, std::optional<double> timer, double triggerRadius, ExplosionParams explosionParams) : playerId(playerId), position(position), size(size), state(state), timer(timer), triggerRadius(triggerRadius), explosionParams(explosionParams) { }
 Mine Mine::readFrom(InputStream& stream) {
     Mine result;
+    readFrom(stream, result);
+    return result;
+}
+void Mine::readFrom(InputStream& stream, Mine& result) {
     result.playerId = stream.readInt();
     result.position = Vec2Double::readFrom(stream);
     result.size = Vec2Double::readFrom(stream);
@@ -24,14 +28,12 @@ Mine Mine::readFrom(InputStream& stream) {
         throw std::runtime_error("Unexpected discriminant value");
     }
     if (stream.readBool()) {
-        result.timer = std::shared_ptr<double>(new double());
-        *result.timer = stream.readDouble();
+        result.timer = stream.readDouble();
     } else {
-        result.timer = std::shared_ptr<double>();
+        result.timer.reset();
     }
     result.triggerRadius = stream.readDouble();
     result.explosionParams = ExplosionParams::readFrom(stream);
-    return result;
 }
 void Mine::writeTo(OutputStream& stream) const {
     stream.write(playerId);
@@ -39,10 +41,10 @@ void Mine::writeTo(OutputStream& stream) const {
     size.writeTo(stream);
     stream.write((int)(state));
     if (timer) {
-        stream.write(false);
-    } else {
         stream.write(true);
         stream.write((*timer));
+    } else {
+        stream.write(false);
     }
     stream.write(triggerRadius);
     explosionParams.writeTo(stream);
@@ -9,7 +9,7 @@
 #include "Vec2Double.hpp"
 #include <stdexcept>
 #include "MineState.hpp"
-#include <memory>
+#include <optional>
 #include <stdexcept>
 #include "ExplosionParams.hpp"
 
@@ -19,12 +19,13 @@ public:
     Vec2Double position;
     Vec2Double size;
     MineState state;
-    std::shared_ptr<double> timer;
+    std::optional<double> timer;
     double triggerRadius;
     ExplosionParams explosionParams;
     Mine();
-    Mine(int playerId, Vec2Double position, Vec2Double size, MineState state, std::shared_ptr<double> timer, double triggerRadius, ExplosionParams explosionParams);
+    Mine(int playerId, Vec2Double position, Vec2Double size, MineState state, std::optional<double> timer, double triggerRadius, ExplosionParams explosionParams);
     static Mine readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, Mine& result);
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
@@ -29,6 +29,10 @@ void PlayerMessageGame::ActionMessage::writeTo(OutputStream& stream) const {
     stream.write(TAG);
     action.writeTo(stream);
 }
+void PlayerMessageGame::ActionMessage::writeTo(OutputStream& stream, const std::pair<int, UnitAction>* actions, size_t actionCount) {
+    stream.write(TAG);
+    Versioned::writeTo(stream, actions, actionCount);
+}
 std::string PlayerMessageGame::ActionMessage::toString() const {
     return std::string("PlayerMessageGame::ActionMessage") + "(" +
         action.toString() +
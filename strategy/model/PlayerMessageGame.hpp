@@ -71,6 +71,8 @@ public:
     ActionMessage(Versioned action);
     static ActionMessage readFrom(InputStream& stream);
     void writeTo(OutputStream& stream) const;
+    // Writes an action message straight from (unit id, action) pairs.
+    static void writeTo(OutputStream& stream, const std::pair<int, UnitAction>* actions, size_t actionCount);
     std::string toString() const override;
 };
 
@@ -4,10 +4,13 @@ PlayerView::PlayerView() { }
 PlayerView::PlayerView(int myId, Game game) : myId(myId), game(game) { }
 PlayerView PlayerView::readFrom(InputStream& stream) {
     PlayerView result;
-    result.myId = stream.readInt();
-    result.game = Game::readFrom(stream);
+    readFrom(stream, result);
     return result;
 }
+void PlayerView::readFrom(InputStream& stream, PlayerView& result) {
+    result.myId = stream.readInt();
+    Game::readFrom(stream, result.game);
+}
 void PlayerView::writeTo(OutputStream& stream) const {
     stream.write(myId);
     game.writeTo(stream);
@@ -101,6 +101,7 @@ public:
     PlayerView();
     PlayerView(int myId, Game game);
     static PlayerView readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, PlayerView& result);
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
@@ -1,9 +1,20 @@
 #include "Properties.hpp"
 
-Properties::Properties() { }
-Properties::Properties(int maxTickCount, int teamSize, double ticksPerSecond, int updatesPerTick, Vec2Double lootBoxSize, Vec2Double unitSize, double unitMaxHorizontalSpeed, double unitFallSpeed, double unitJumpTime, double unitJumpSpeed, double jumpPadJumpTime, double jumpPadJumpSpeed, int unitMaxHealth, int healthPackHealth, std::unordered_map<WeaponType, WeaponParams> weaponParams, Vec2Double mineSize, ExplosionParams mineExplosionParams, double minePrepareTime, double mineTriggerTime, double mineTriggerRadius, int killScore) : maxTickCount(maxTickCount), teamSize(teamSize), ticksPerSecond(ticksPerSecond), updatesPerTick(updatesPerTick), lootBoxSize(lootBoxSize), unitSize(unitSize), unitMaxHorizontalSpeed(unitMaxHorizontalSpeed), unitFallSpeed(unitFallSpeed), unitJumpTime(unitJumpTime), unitJumpSpeed(unitJumpSpeed), jumpPadJumpTime(jumpPadJumpTime), jumpPadJumpSpeed(jumpPadJumpSpeed), unitMaxHealth(unitMaxHealth), healthPackHealth(healthPackHealth), weaponParams(weaponParams), mineSize(mineSize), mineExplosionParams(mineExplosionParams), minePrepareTime(minePrepareTime), mineTriggerTime(mineTriggerTime), mineTriggerRadius(mineTriggerRadius), killScore(killScore) { }
+// Every field except the weapon parameter entries: 8 ints and 17 doubles.
+static const size_t FIXED_ENCODED_SIZE = 8 * sizeof(int) + 17 * sizeof(double);
+
+Properties::Properties() : decodedSize(0) { }
+Properties::Properties(int maxTickCount, int teamSize, double ticksPerSecond, int updatesPerTick, Vec2Double lootBoxSize, Vec2Double unitSize, double unitMaxHorizontalSpeed, double unitFallSpeed, double unitJumpTime, double unitJumpSpeed, double jumpPadJumpTime, double jumpPadJumpSpeed, int unitMaxHealth, int healthPackHealth, std::array<WeaponParams, WEAPON_TYPE_COUNT> weaponParams, Vec2Double mineSize, ExplosionParams mineExplosionParams, double minePrepareTime, double mineTriggerTime, double mineTriggerRadius, int killScore) : maxTickCount(maxTickCount), teamSize(teamSize), ticksPerSecond(ticksPerSecond), updatesPerTick(updatesPerTick), lootBoxSize(lootBoxSize), unitSize(unitSize), unitMaxHorizontalSpeed(unitMaxHorizontalSpeed), unitFallSpeed(unitFallSpeed), unitJumpTime(unitJumpTime), unitJumpSpeed(unitJumpSpeed), jumpPadJumpTime(jumpPadJumpTime), jumpPadJumpSpeed(jumpPadJumpSpeed), unitMaxHealth(unitMaxHealth), healthPackHealth(healthPackHealth), weaponParams(weaponParams), mineSize(mineSize), mineExplosionParams(mineExplosionParams), minePrepareTime(minePrepareTime), mineTriggerTime(mineTriggerTime), mineTriggerRadius(mineTriggerRadius), killScore(killScore), decodedSize(0) { }
 Properties Properties::readFrom(InputStream& stream) {
     Properties result;
+    readFrom(stream, result);
+    return result;
+}
+void Properties::readFrom(InputStream& stream, Properties& result) {
+    if (result.decodedSize != 0) {
+        stream.skipBytes(result.decodedSize);
+        return;
+    }
     result.maxTickCount = stream.readInt();
     result.teamSize = stream.readInt();
     result.ticksPerSecond = stream.readDouble();
@@ -19,8 +30,7 @@ Properties Properties::readFrom(InputStream& stream) {
     result.unitMaxHealth = stream.readInt();
     result.healthPackHealth = stream.readInt();
     size_t weaponParamsSize = stream.readInt();
-    result.weaponParams = std::unordered_map<WeaponType, WeaponParams>();
-    result.weaponParams.reserve(weaponParamsSize);
+    size_t weaponParamsEncodedSize = 0;
     for (size_t i = 0; i < weaponParamsSize; i++) {
         WeaponType weaponParamsKey;
         switch (stream.readInt()) {
@@ -36,9 +46,8 @@ Properties Properties::readFrom(InputStream& stream) {
         default:
             throw std::runtime_error("Unexpected discriminant value");
         }
-        WeaponParams weaponParamsValue;
-        weaponParamsValue = WeaponParams::readFrom(stream);
-        result.weaponParams.emplace(std::make_pair(weaponParamsKey, weaponParamsValue));
+        WeaponParams::readFrom(stream, result.weaponParams[weaponParamsKey]);
+        weaponParamsEncodedSize += sizeof(int) + result.weaponParams[weaponParamsKey].encodedSize();
     }
     result.mineSize = Vec2Double::readFrom(stream);
     result.mineExplosionParams = ExplosionParams::readFrom(stream);
@@ -46,7 +55,7 @@ Properties Properties::readFrom(InputStream& stream) {
     result.mineTriggerTime = stream.readDouble();
     result.mineTriggerRadius = stream.readDouble();
     result.killScore = stream.readInt();
-    return result;
+    result.decodedSize = FIXED_ENCODED_SIZE + weaponParamsEncodedSize;
 }
 void Properties::writeTo(OutputStream& stream) const {
     stream.write(maxTickCount);
@@ -64,9 +73,9 @@ void Properties::writeTo(OutputStream& stream) const {
     stream.write(unitMaxHealth);
     stream.write(healthPackHealth);
     stream.write((int)(weaponParams.size()));
-    for (const auto& weaponParamsEntry : weaponParams) {
-        stream.write((int)(weaponParamsEntry.first));
-        weaponParamsEntry.second.writeTo(stream);
+    for (size_t i = 0; i < weaponParams.size(); i++) {
+        stream.write((int)(i));
+        weaponParams[i].writeTo(stream);
     }
     mineSize.writeTo(stream);
     mineExplosionParams.writeTo(stream);
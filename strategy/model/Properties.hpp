@@ -7,14 +7,14 @@
 #include "Vec2Double.hpp"
 #include <stdexcept>
 #include "Vec2Double.hpp"
-#include <unordered_map>
+#include <array>
 #include <stdexcept>
 #include "WeaponType.hpp"
 #include <stdexcept>
 #include "WeaponParams.hpp"
 #include <stdexcept>
 #include "BulletParams.hpp"
-#include <memory>
+#include <optional>
 #include <stdexcept>
 #include "ExplosionParams.hpp"
 #include <stdexcept>
@@ -38,16 +38,21 @@ public:
     double jumpPadJumpSpeed;
     int unitMaxHealth;
     int healthPackHealth;
-    std::unordered_map<WeaponType, WeaponParams> weaponParams;
+    // Indexed by WeaponType.
+    std::array<WeaponParams, WEAPON_TYPE_COUNT> weaponParams;
     Vec2Double mineSize;
     ExplosionParams mineExplosionParams;
     double minePrepareTime;
     double mineTriggerTime;
     double mineTriggerRadius;
     int killScore;
+    // Size of the encoded block once decoded; the properties never change
+    // during a game, so later ticks skip this many bytes.
+    size_t decodedSize;
     Properties();
-    Properties(int maxTickCount, int teamSize, double ticksPerSecond, int updatesPerTick, Vec2Double lootBoxSize, Vec2Double unitSize, double unitMaxHorizontalSpeed, double unitFallSpeed, double unitJumpTime, double unitJumpSpeed, double jumpPadJumpTime, double jumpPadJumpSpeed, int unitMaxHealth, int healthPackHealth, std::unordered_map<WeaponType, WeaponParams> weaponParams, Vec2Double mineSize, ExplosionParams mineExplosionParams, double minePrepareTime, double mineTriggerTime, double mineTriggerRadius, int killScore);
+    Properties(int maxTickCount, int teamSize, double ticksPerSecond, int updatesPerTick, Vec2Double lootBoxSize, Vec2Double unitSize, double unitMaxHorizontalSpeed, double unitFallSpeed, double unitJumpTime, double unitJumpSpeed, double jumpPadJumpTime, double jumpPadJumpSpeed, int unitMaxHealth, int healthPackHealth, std::array<WeaponParams, WEAPON_TYPE_COUNT> weaponParams, Vec2Double mineSize, ExplosionParams mineExplosionParams, double minePrepareTime, double mineTriggerTime, double mineTriggerRadius, int killScore);
     static Properties readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, Properties& result);
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
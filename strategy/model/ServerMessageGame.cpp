@@ -4,20 +4,25 @@ ServerMessageGame::ServerMessageGame() { }
 ServerMessageGame::ServerMessageGame(std::shared_ptr<PlayerView> playerView) : playerView(playerView) { }
 ServerMessageGame ServerMessageGame::readFrom(InputStream& stream) {
     ServerMessageGame result;
+    readFrom(stream, result);
+    return result;
+}
+void ServerMessageGame::readFrom(InputStream& stream, ServerMessageGame& result) {
     if (stream.readBool()) {
-        result.playerView = std::shared_ptr<PlayerView>(new PlayerView());
-        *result.playerView = PlayerView::readFrom(stream);
+        if (!result.playerView) {
+            result.playerView = std::shared_ptr<PlayerView>(new PlayerView());
+        }
+        PlayerView::readFrom(stream, *result.playerView);
     } else {
         result.playerView = std::shared_ptr<PlayerView>();
     }
-    return result;
 }
 void ServerMessageGame::writeTo(OutputStream& stream) const {
     if (playerView) {
-        stream.write(false);
-    } else {
         stream.write(true);
         (*playerView).writeTo(stream);
+    } else {
+        stream.write(false);
     }
 }
 std::string ServerMessageGame::toString() const {
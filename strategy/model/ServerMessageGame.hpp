@@ -103,6 +103,7 @@ public:
     ServerMessageGame();
     ServerMessageGame(std::shared_ptr<PlayerView> playerView);
     static ServerMessageGame readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, ServerMessageGame& result);
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
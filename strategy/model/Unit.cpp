@@ -1,9 +1,13 @@
 #include "Unit.hpp"
 
 Unit::Unit() { }
-Unit::Unit(int playerId, int id, int health, Vec2Double position, Vec2Double size, JumpState jumpState, bool walkedRight, bool stand, bool onGround, bool onLadder, int mines, std::shared_ptr<Weapon> weapon) : playerId(playerId), id(id), health(health), position(position), size(size), jumpState(jumpState), walkedRight(walkedRight), stand(stand), onGround(onGround), onLadder(onLadder), mines(mines), weapon(weapon) { }
+Unit::Unit(int playerId, int id, int health, Vec2Double position, Vec2Double size, JumpState jumpState, bool walkedRight, bool stand, bool onGround, bool onLadder, int mines, std::optional<Weapon> weapon) : playerId(playerId), id(id), health(health), position(position), size(size), jumpState(jumpState), walkedRight(walkedRight), stand(stand), onGround(onGround), onLadder(onLadder), mines(mines), weapon(weapon) { }
 Unit Unit::readFrom(InputStream& stream) {
     Unit result;
+    readFrom(stream, result);
+    return result;
+}
+void Unit::readFrom(InputStream& stream, Unit& result) {
     result.playerId = stream.readInt();
     result.id = stream.readInt();
     result.health = stream.readInt();
@@ -16,12 +20,13 @@ Unit Unit::readFrom(InputStream& stream) {
     result.onLadder = stream.readBool();
     result.mines = stream.readInt();
     if (stream.readBool()) {
-        result.weapon = std::shared_ptr<Weapon>(new Weapon());
-        *result.weapon = Weapon::readFrom(stream);
+        if (!result.weapon) {
+            result.weapon.emplace();
+        }
+        Weapon::readFrom(stream, *result.weapon);
     } else {
-        result.weapon = std::shared_ptr<Weapon>();
+        result.weapon.reset();
     }
-    return result;
 }
 void Unit::writeTo(OutputStream& stream) const {
     stream.write(playerId);
@@ -36,10 +41,10 @@ void Unit::writeTo(OutputStream& stream) const {
     stream.write(onLadder);
     stream.write(mines);
     if (weapon) {
-        stream.write(false);
-    } else {
         stream.write(true);
         (*weapon).writeTo(stream);
+    } else {
+        stream.write(false);
     }
 }
 std::string Unit::toString() const {
@@ -9,7 +9,7 @@
 #include "Vec2Double.hpp"
 #include <stdexcept>
 #include "JumpState.hpp"
-#include <memory>
+#include <optional>
 #include <stdexcept>
 #include "Weapon.hpp"
 #include <stdexcept>
@@ -21,9 +21,9 @@
 #include <memory>
 #include <stdexcept>
 #include "ExplosionParams.hpp"
-#include <memory>
-#include <memory>
-#include <memory>
+#include <optional>
+#include <optional>
+#include <optional>
 
 class Unit {
 public:
@@ -38,10 +38,11 @@ public:
     bool onGround;
     bool onLadder;
     int mines;
-    std::shared_ptr<Weapon> weapon;
+    std::optional<Weapon> weapon;
     Unit();
-    Unit(int playerId, int id, int health, Vec2Double position, Vec2Double size, JumpState jumpState, bool walkedRight, bool stand, bool onGround, bool onLadder, int mines, std::shared_ptr<Weapon> weapon);
+    Unit(int playerId, int id, int health, Vec2Double position, Vec2Double size, JumpState jumpState, bool walkedRight, bool stand, bool onGround, bool onLadder, int mines, std::optional<Weapon> weapon);
     static Unit readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, Unit& result);
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
@@ -24,6 +24,14 @@ void Versioned::writeTo(OutputStream& stream) const {
         innerEntry.second.writeTo(stream);
     }
 }
+void Versioned::writeTo(OutputStream& stream, const std::pair<int, UnitAction>* inner, size_t innerSize) {
+    stream.write(43981);
+    stream.write((int)(innerSize));
+    for (size_t i = 0; i < innerSize; i++) {
+        stream.write(inner[i].first);
+        inner[i].second.writeTo(stream);
+    }
+}
 std::string Versioned::toString() const {
     return std::string("Versioned") + "(" +
         "TODO" + 
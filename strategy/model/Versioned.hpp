@@ -3,6 +3,7 @@
 
 #include "../Stream.hpp"
 #include <string>
+#include <utility>
 #include <unordered_map>
 #include <stdexcept>
 #include "UnitAction.hpp"
@@ -16,6 +17,7 @@ public:
     Versioned(std::unordered_map<int, UnitAction> inner);
     static Versioned readFrom(InputStream& stream);
     void writeTo(OutputStream& stream) const;
+    static void writeTo(OutputStream& stream, const std::pair<int, UnitAction>* inner, size_t innerSize);
     std::string toString() const;
 };
 
@@ -1,9 +1,13 @@
 #include "Weapon.hpp"
 
 Weapon::Weapon() { }
-Weapon::Weapon(WeaponType typ, WeaponParams params, int magazine, bool wasShooting, double spread, std::shared_ptr<double> fireTimer, std::shared_ptr<double> lastAngle, std::shared_ptr<int> lastFireTick) : typ(typ), params(params), magazine(magazine), wasShooting(wasShooting), spread(spread), fireTimer(fireTimer), lastAngle(lastAngle), lastFireTick(lastFireTick) { }
+Weapon::Weapon(WeaponType typ, WeaponParams params, int magazine, bool wasShooting, double spread, std::optional<double> fireTimer, std::optional<double> lastAngle, std::optional<int> lastFireTick) : typ(typ), params(params), magazine(magazine), wasShooting(wasShooting), spread(spread), fireTimer(fireTimer), lastAngle(lastAngle), lastFireTick(lastFireTick) { }
 Weapon Weapon::readFrom(InputStream& stream) {
     Weapon result;
+    readFrom(stream, result);
+    return result;
+}
+void Weapon::readFrom(InputStream& stream, Weapon& result) {
     switch (stream.readInt()) {
     case 0:
         result.typ = WeaponType::PISTOL;
@@ -17,29 +21,25 @@ Weapon Weapon::readFrom(InputStream& stream) {
     default:
         throw std::runtime_error("Unexpected discriminant value");
     }
-    result.params = WeaponParams::readFrom(stream);
+    WeaponParams::readFrom(stream, result.params);
     result.magazine = stream.readInt();
     result.wasShooting = stream.readBool();
     result.spread = stream.readDouble();
     if (stream.readBool()) {
-        result.fireTimer = std::shared_ptr<double>(new double());
-        *result.fireTimer = stream.readDouble();
+        result.fireTimer = stream.readDouble();
     } else {
-        result.fireTimer = std::shared_ptr<double>();
+        result.fireTimer.reset();
     }
     if (stream.readBool()) {
-        result.lastAngle = std::shared_ptr<double>(new double());
-        *result.lastAngle = stream.readDouble();
+        result.lastAngle = stream.readDouble();
     } else {
-        result.lastAngle = std::shared_ptr<double>();
+        result.lastAngle.reset();
     }
     if (stream.readBool()) {
-        result.lastFireTick = std::shared_ptr<int>(new int());
-        *result.lastFireTick = stream.readInt();
+        result.lastFireTick = stream.readInt();
     } else {
-        result.lastFireTick = std::shared_ptr<int>();
+        result.lastFireTick.reset();
     }
-    return result;
 }
 void Weapon::writeTo(OutputStream& stream) const {
     stream.write((int)(typ));
@@ -48,22 +48,22 @@ void Weapon::writeTo(OutputStream& stream) const {
     stream.write(wasShooting);
     stream.write(spread);
     if (fireTimer) {
-        stream.write(false);
-    } else {
         stream.write(true);
         stream.write((*fireTimer));
+    } else {
+        stream.write(false);
     }
     if (lastAngle) {
-        stream.write(false);
-    } else {
         stream.write(true);
         stream.write((*lastAngle));
+    } else {
+        stream.write(false);
     }
     if (lastFireTick) {
-        stream.write(false);
-    } else {
         stream.write(true);
         stream.write((*lastFireTick));
+    } else {
+        stream.write(false);
     }
 }
 std::string Weapon::toString() const {
@@ -12,9 +12,9 @@
 #include <memory>
 #include <stdexcept>
 #include "ExplosionParams.hpp"
-#include <memory>
-#include <memory>
-#include <memory>
+#include <optional>
+#include <optional>
+#include <optional>
 
 class Weapon {
 public:
@@ -23,12 +23,13 @@ public:
     int magazine;
     bool wasShooting;
     double spread;
-    std::shared_ptr<double> fireTimer;
-    std::shared_ptr<double> lastAngle;
-    std::shared_ptr<int> lastFireTick;
+    std::optional<double> fireTimer;
+    std::optional<double> lastAngle;
+    std::optional<int> lastFireTick;
     Weapon();
-    Weapon(WeaponType typ, WeaponParams params, int magazine, bool wasShooting, double spread, std::shared_ptr<double> fireTimer, std::shared_ptr<double> lastAngle, std::shared_ptr<int> lastFireTick);
+    Weapon(WeaponType typ, WeaponParams params, int magazine, bool wasShooting, double spread, std::optional<double> fireTimer, std::optional<double> lastAngle, std::optional<int> lastFireTick);
     static Weapon readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, Weapon& result);
     void writeTo(OutputStream& stream) const;
     std::string toString() const;
 };
@@ -1,9 +1,13 @@
 #include "WeaponParams.hpp"
 
 WeaponParams::WeaponParams() { }
-WeaponParams::WeaponParams(int magazineSize, double fireRate, double reloadTime, double minSpread, double maxSpread, double recoil, double aimSpeed, BulletParams bullet, std::shared_ptr<ExplosionParams> explosion) : magazineSize(magazineSize), fireRate(fireRate), reloadTime(reloadTime), minSpread(minSpread), maxSpread(maxSpread), recoil(recoil), aimSpeed(aimSpeed), bullet(bullet), explosion(explosion) { }
+WeaponParams::WeaponParams(int magazineSize, double fireRate, double reloadTime, double minSpread, double maxSpread, double recoil, double aimSpeed, BulletParams bullet, std::optional<ExplosionParams> explosion) : magazineSize(magazineSize), fireRate(fireRate), reloadTime(reloadTime), minSpread(minSpread), maxSpread(maxSpread), recoil(recoil), aimSpeed(aimSpeed), bullet(bullet), explosion(explosion) { }
 WeaponParams WeaponParams::readFrom(InputStream& stream) {
     WeaponParams result;
+    readFrom(stream, result);
+    return result;
+}
+void WeaponParams::readFrom(InputStream& stream, WeaponParams& result) {
     result.magazineSize = stream.readInt();
     result.fireRate = stream.readDouble();
     result.reloadTime = stream.readDouble();
@@ -13,12 +17,10 @@ WeaponParams WeaponParams::readFrom(InputStream& stream) {
     result.aimSpeed = stream.readDouble();
     result.bullet = BulletParams::readFrom(stream);
     if (stream.readBool()) {
-        result.explosion = std::shared_ptr<ExplosionParams>(new ExplosionParams());
-        *result.explosion = ExplosionParams::readFrom(stream);
+        result.explosion = ExplosionParams::readFrom(stream);
     } else {
-        result.explosion = std::shared_ptr<ExplosionParams>();
+        result.explosion.reset();
     }
-    return result;
 }
 void WeaponParams::writeTo(OutputStream& stream) const {
     stream.write(magazineSize);
@@ -30,12 +32,21 @@ void WeaponParams::writeTo(OutputStream& stream) const {
     stream.write(aimSpeed);
     bullet.writeTo(stream);
     if (explosion) {
-        stream.write(false);
-    } else {
         stream.write(true);
         (*explosion).writeTo(stream);
+    } else {
+        stream.write(false);
     }
 }
+size_t WeaponParams::encodedSize() const {
+    size_t result = sizeof(int) + 6 * sizeof(double);
+    result += 2 * sizeof(double) + sizeof(int);
+    result += sizeof(bool);
+    if (explosion) {
+        result += sizeof(double) + sizeof(int);
+    }
+    return result;
+}
 std::string WeaponParams::toString() const {
     return std::string("WeaponParams") + "(" +
         std::to_string(magazineSize) +
@@ -5,7 +5,7 @@
 #include <string>
 #include <stdexcept>
 #include "BulletParams.hpp"
-#include <memory>
+#include <optional>
 #include <stdexcept>
 #include "ExplosionParams.hpp"
 
@@ -19,11 +19,13 @@ public:
     double recoil;
     double aimSpeed;
     BulletParams bullet;
-    std::shared_ptr<ExplosionParams> explosion;
+    std::optional<ExplosionParams> explosion;
     WeaponParams();
-    WeaponParams(int magazineSize, double fireRate, double reloadTime, double minSpread, double maxSpread, double recoil, double aimSpeed, BulletParams bullet, std::shared_ptr<ExplosionParams> explosion);
+    WeaponParams(int magazineSize, double fireRate, double reloadTime, double minSpread, double maxSpread, double recoil, double aimSpeed, BulletParams bullet, std::optional<ExplosionParams> explosion);
     static WeaponParams readFrom(InputStream& stream);
+    static void readFrom(InputStream& stream, WeaponParams& result);
     void writeTo(OutputStream& stream) const;
+    size_t encodedSize() const;
     std::string toString() const;
 };
 
@@ -9,4 +9,6 @@ enum WeaponType {
     ROCKET_LAUNCHER = 2
 };
 
+const int WEAPON_TYPE_COUNT = 3;
+
 #endif
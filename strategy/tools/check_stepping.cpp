@@ -0,0 +1,167 @@
+// Checks that Simulator::SKIP_TO_EVENTS moves units exactly as
+// EVERY_MICROTICK does. Random units walk and jump through random levels
+// under both modes; any tick after which a unit's position, jump state or
+// contact flags differ is reported, and the exit status is non-zero.
+//
+// Built only with -DCHECK_STEPPING=ON; the bot itself never pays for it.
+
+#include "../Simulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr int LEVELS = 50;
+	constexpr int TICKS = 600;
+	constexpr int UNITS = 4;
+	constexpr size_t WIDTH = 40;
+	constexpr size_t HEIGHT = 30;
+
+	Properties make_properties()
+	{
+		Properties properties;
+		properties.maxTickCount = 3600;
+		properties.teamSize = UNITS / 2;
+		properties.ticksPerSecond = 60.0;
+		properties.updatesPerTick = 100;
+		properties.lootBoxSize = Vec2Double(0.5, 0.5);
+		properties.unitSize = Vec2Double(0.9, 1.8);
+		properties.unitMaxHorizontalSpeed = 10.0;
+		properties.unitFallSpeed = 10.0;
+		properties.unitJumpTime = 0.55;
+		properties.unitJumpSpeed = 10.0;
+		properties.jumpPadJumpTime = 0.525;
+		properties.jumpPadJumpSpeed = 20.0;
+		properties.unitMaxHealth = 100;
+		properties.healthPackHealth = 50;
+		properties.mineSize = Vec2Double(0.5, 0.5);
+		properties.mineExplosionParams = ExplosionParams(3.0, 50);
+		properties.minePrepareTime = 1.0;
+		properties.mineTriggerTime = 0.5;
+		properties.mineTriggerRadius = 1.0;
+		properties.killScore = 1000;
+		return properties;
+	}
+
+	// Walled box with runs of walls and platforms, ladders and jump pads,
+	// so that units keep crossing every kind of tile boundary.
+	std::vector<std::vector<Tile>> make_tiles(std::mt19937 & random)
+	{
+		std::vector<std::vector<Tile>> tiles(WIDTH, std::vector<Tile>(HEIGHT, EMPTY));
+		for (size_t x = 0; x < WIDTH; ++x)
+			tiles[x][0] = tiles[x][HEIGHT - 1] = WALL;
+		for (size_t y = 0; y < HEIGHT; ++y)
+			tiles[0][y] = tiles[WIDTH - 1][y] = WALL;
+		std::uniform_int_distribution<size_t> column(1, WIDTH - 2);
+		std::uniform_int_distribution<size_t> row(3, HEIGHT - 4);
+		std::uniform_int_distribution<size_t> length(2, 8);
+		std::uniform_int_distribution<int> kind(0, 9);
+		for (int i = 0; i < 30; ++i)
+		{
+			auto const x = column(random);
+			auto const y = row(random);
+			auto const k = kind(random);
+			if (k < 6)
+			{
+				auto const tile = k < 4 ? WALL : PLATFORM;
+				for (auto i = x, end = std::min(x + length(random), WIDTH - 1); i < end && tiles[i][y] == EMPTY; ++i)
+					tiles[i][y] = tile;
+			}
+			else if (k < 8)
+			{
+				for (auto low = y, end = std::min(y + length(random), HEIGHT - 1); low < end && tiles[x][low] == EMPTY; ++low)
+					tiles[x][low] = LADDER;
+			}
+			else if (tiles[x][y] == EMPTY)
+				tiles[x][y] = JUMP_PAD;
+		}
+		return tiles;
+	}
+
+	// Units start in empty columns two tiles high, clear of each other.
+	std::vector<Unit> make_units(Level const& level, Properties const& properties, std::mt19937 & random)
+	{
+		std::vector<Unit> units;
+		std::uniform_int_distribution<size_t> column(1, WIDTH - 2);
+		std::uniform_int_distribution<size_t> row(1, HEIGHT - 3);
+		while (units.size() < UNITS)
+		{
+			auto const x = column(random);
+			auto const y = row(random);
+			if (level.getTile(x, y) != EMPTY || level.getTile(x, y + 1) != EMPTY)
+				continue;
+			auto clear = true;
+			for (auto const& other : units)
+				clear = clear && (std::abs(other.position.x - (x + 0.5)) > 1.0 || std::abs(other.position.y - y) > 2.0);
+			if (!clear)
+				continue;
+			auto const id = static_cast<int>(units.size()) + 1;
+			units.emplace_back(id % 2 + 1, id, properties.unitMaxHealth, Vec2Double(x + 0.5, y), properties.unitSize,
+				JumpState(false, 0.0, 0.0, false), false, true, false, false, 0, std::nullopt);
+		}
+		return units;
+	}
+
+	bool same_motion(Unit const& a, Unit const& b)
+	{
+		return a.position.x == b.position.x && a.position.y == b.position.y
+			&& a.jumpState.canJump == b.jumpState.canJump && a.jumpState.speed == b.jumpState.speed
+			&& a.jumpState.maxTime == b.jumpState.maxTime && a.jumpState.canCancel == b.jumpState.canCancel
+			&& a.onGround == b.onGround && a.onLadder == b.onLadder;
+	}
+}
+
+int main()
+{
+	std::mt19937 random(2019);
+	std::uniform_real_distribution<double> velocity(-12.0, 12.0);
+	std::uniform_int_distribution<int> choice(0, 9);
+	auto const properties = make_properties();
+	auto mismatches = 0;
+	for (int l = 0; l < LEVELS; ++l)
+	{
+		Game stepped;
+		stepped.properties = properties;
+		stepped.level = Level(make_tiles(random));
+		stepped.units = make_units(stepped.level, properties, random);
+		auto skipped = stepped;
+		Simulator const every(properties, stepped.level, Simulator::EVERY_MICROTICK);
+		Simulator const events(properties, skipped.level, Simulator::SKIP_TO_EVENTS);
+		std::vector<UnitAction> actions(UNITS);
+		for (int t = 0; t < TICKS; ++t)
+		{
+			// Actions are held for a few ticks at a time, so that units
+			// also get to finish their jumps and walks.
+			for (auto & action : actions)
+				if (choice(random) < 3)
+				{
+					action.velocity = choice(random) < 2 ? 0.0 : velocity(random);
+					action.jump = choice(random) < 4;
+					action.jumpDown = !action.jump && choice(random) < 2;
+				}
+			every.tick(stepped, actions.data());
+			events.tick(skipped, actions.data());
+			for (size_t i = 0; i < stepped.units.size(); ++i)
+				if (!same_motion(stepped.units[i], skipped.units[i]))
+				{
+					std::cerr << "level " << l << ", tick " << t << ": unit " << stepped.units[i].id
+						<< " stepped to " << stepped.units[i].position.toString()
+						<< " but skipped to " << skipped.units[i].position.toString() << std::endl;
+					++mismatches;
+					skipped.units[i] = stepped.units[i];
+				}
+		}
+	}
+	if (mismatches > 0)
+	{
+		std::cerr << mismatches << " mismatches" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << LEVELS << " levels, " << TICKS << " ticks each: no mismatches" << std::endl;
+	return EXIT_SUCCESS;
+}